@@ -179,6 +179,7 @@ SOURCES += src/main.cpp\
     src/info/infocontroller.cpp \
     src/common/symbolpainter.cpp \
     src/db/databasemanager.cpp \
+    src/db/databasepool.cpp \
     src/db/dbtypes.cpp \
     src/common/constants.cpp \
     src/export/csvexporter.cpp \
@@ -216,6 +217,8 @@ SOURCES += src/main.cpp\
     src/query/airportquery.cpp \
     src/query/infoquery.cpp \
     src/query/mapquery.cpp \
+    src/query/navsnapshot.cpp \
+    src/query/procedurecache.cpp \
     src/query/procedurequery.cpp \
     src/mapgui/mapvisible.cpp \
     src/search/userdatasearch.cpp \
@@ -258,6 +261,7 @@ HEADERS  += src/gui/mainwindow.h \
     src/mapgui/mappaintermark.h \
     src/mapgui/mapscale.h \
     src/search/airporticondelegate.h \
+    src/search/sqlmodelrowcache.h \
     src/common/maptypes.h \
     src/common/mapcolors.h \
     src/mapgui/mappainternav.h \
@@ -286,6 +290,7 @@ HEADERS  += src/gui/mainwindow.h \
     src/info/infocontroller.h \
     src/common/symbolpainter.h \
     src/db/databasemanager.h \
+    src/db/databasepool.h \
     src/db/dbtypes.h \
     src/common/constants.h \
     src/export/csvexporter.h \
@@ -323,6 +328,8 @@ HEADERS  += src/gui/mainwindow.h \
     src/query/airportquery.h \
     src/query/infoquery.h \
     src/query/mapquery.h \
+    src/query/navsnapshot.h \
+    src/query/procedurecache.h \
     src/query/procedurequery.h \
     src/mapgui/mapvisible.h \
     src/search/userdatasearch.h \
@@ -174,6 +174,7 @@ const QLatin1Literal SEARCHTAB_ONLINE_SERVER_VIEW_WIDGET("SearchPaneOnlineServer
 const QLatin1Literal SETTINGS_INFOQUERY("Settings/InfoQuery");
 const QLatin1Literal SETTINGS_MAPQUERY("Settings/MapQuery");
 const QLatin1Literal SETTINGS_DATABASE("Settings/Database");
+const QLatin1Literal SETTINGS_SEARCH("Settings/Search");
 
 const QLatin1Literal APPROACHTREE_WIDGET("ApproachTree/Widget");
 const QLatin1Literal APPROACHTREE_SELECTED_WIDGET("ApproachTree/WidgetSelected");
@@ -30,6 +30,8 @@
 #include <marble/ElevationModel.h>
 
 #include <QMessageBox>
+#include <QElapsedTimer>
+#include <QtConcurrent/QtConcurrentRun>
 
 /* Limt altitude to this value */
 static Q_DECL_CONSTEXPR float ALTITUDE_LIMIT_METER = 8800.f;
@@ -48,11 +50,13 @@ ElevationProvider::ElevationProvider(QObject *parent, const Marble::ElevationMod
 {
   // Marble will let us know when updates are available
   connect(marbleModel, &ElevationModel::updateAvailable, this, &ElevationProvider::marbleUpdateAvailable);
+  connect(&globeWatcher, &QFutureWatcher<GlobeReader *>::finished, this, &ElevationProvider::globeReaderOpened);
   updateReader();
 }
 
 ElevationProvider::~ElevationProvider()
 {
+  cancelGlobeReader();
   delete globeReader;
 }
 
@@ -156,6 +160,9 @@ void ElevationProvider::optionsChanged()
 
 void ElevationProvider::updateReader()
 {
+  // Called with mutex locked on options change
+  cancelGlobeReader();
+
   if(OptionData::instance().getFlags() & opts::CACHE_USE_OFFLINE_ELEVATION)
   {
     const QString& path = OptionData::instance().getOfflineElevationPath();
@@ -167,19 +174,16 @@ void ElevationProvider::updateReader()
     }
     else
     {
+      // Use online elevation until files are opened
       delete globeReader;
-      globeReader = new GlobeReader(path);
-      {
-        qDebug() << Q_FUNC_INFO << "Opening GLOBE files";
-
-        if(!globeReader->openFiles())
-        {
-          NavApp::deleteSplashScreen();
-          atools::gui::Dialog::warning(NavApp::getQMainWidget(),
-                                       tr("Cannot open GLOBE data in directory<br/><i>%1</i>").arg(path));
-          qDebug() << Q_FUNC_INFO << "Opening GLOBE done";
-        }
-      }
+      globeReader = nullptr;
+
+      qDebug() << Q_FUNC_INFO << "Opening GLOBE files";
+      globePath = path;
+      globeOpening = true;
+      globeFuture = QtConcurrent::run(&ElevationProvider::openGlobeReaderThread, new GlobeReader(path));
+      globeWatcher.setFuture(globeFuture);
+      return;
     }
   }
   else
@@ -190,3 +194,54 @@ void ElevationProvider::updateReader()
 
   emit updateAvailable();
 }
+
+GlobeReader *ElevationProvider::openGlobeReaderThread(GlobeReader *reader)
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  if(!reader->openFiles())
+  {
+    delete reader;
+    reader = nullptr;
+  }
+
+  qInfo() << Q_FUNC_INFO << "Opening GLOBE files took" << timer.elapsed() << "ms";
+  return reader;
+}
+
+void ElevationProvider::globeReaderOpened()
+{
+  if(!globeOpening)
+    // Discarded by cancelGlobeReader()
+    return;
+
+  globeOpening = false;
+  GlobeReader *reader = globeFuture.result();
+
+  if(reader == nullptr)
+  {
+    NavApp::deleteSplashScreen();
+    atools::gui::Dialog::warning(NavApp::getQMainWidget(),
+                                 tr("Cannot open GLOBE data in directory<br/><i>%1</i>").arg(globePath));
+  }
+  else
+  {
+    QMutexLocker locker(&mutex);
+    globeReader = reader;
+  }
+  qDebug() << Q_FUNC_INFO << "Opening GLOBE done";
+
+  emit updateAvailable();
+}
+
+void ElevationProvider::cancelGlobeReader()
+{
+  if(globeOpening)
+  {
+    // Worker cannot be interrupted - wait and discard the result
+    globeOpening = false;
+    globeFuture.waitForFinished();
+    delete globeFuture.result();
+  }
+}
@@ -20,6 +20,7 @@
 
 #include <QMutex>
 #include <QObject>
+#include <QFutureWatcher>
 
 namespace Marble {
 class ElevationModel;
@@ -81,12 +82,26 @@ private:
   void marbleUpdateAvailable();
   void updateReader();
 
+  /* Open GLOBE files in a worker thread and pass the reader back. Reader is deleted on failure. */
+  static atools::fs::common::GlobeReader *openGlobeReaderThread(atools::fs::common::GlobeReader *reader);
+
+  /* Called in GUI thread when GLOBE files are opened */
+  void globeReaderOpened();
+
+  /* Wait for a running worker and delete its reader */
+  void cancelGlobeReader();
+
   const Marble::ElevationModel *marbleModel = nullptr;
   atools::fs::common::GlobeReader *globeReader = nullptr;
 
   /* Need to synchronize here since it is called from profile widget thread */
   mutable QMutex mutex;
 
+  /* GLOBE files are opened in background on startup or options change. Online elevation is used until ready. */
+  QFuture<atools::fs::common::GlobeReader *> globeFuture;
+  QFutureWatcher<atools::fs::common::GlobeReader *> globeWatcher;
+  QString globePath;
+  bool globeOpening = false;
 };
 
 #endif // LITTLENAVMAP_ELEVATIONPROVIDER_H
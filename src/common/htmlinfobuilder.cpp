@@ -1718,20 +1718,24 @@ void HtmlInfoBuilder::waypointText(const MapWaypoint& waypoint, HtmlBuilder& htm
 }
 
 void HtmlInfoBuilder::bearingText(const atools::geo::Pos& pos, float magVar, HtmlBuilder& html) const
+{
+  QString text = bearingAndDistanceTexts(pos, magVar);
+  if(!text.isEmpty())
+    html.row2(tr("Bearing and distance:"), text);
+}
+
+QString HtmlInfoBuilder::bearingAndDistanceTexts(const atools::geo::Pos& pos, float magVar) const
 {
   const atools::fs::sc::SimConnectUserAircraft& userAircraft = NavApp::getUserAircraft();
 
   float distance = pos.distanceMeterTo(userAircraft.getPosition());
   if(NavApp::isConnectedAndAircraft() && distance < MAX_DISTANCE_FOR_BEARING_METER)
   {
-    QString txt, msg(tr("Bearing and distance:"));
-
     float bearing = normalizeCourse(userAircraft.getPosition().angleDegToRhumb(pos));
     bearing = normalizeCourse(bearing - magVar);
-    html.row2(msg, tr("%1°M, %2").
-              arg(locale.toString(bearing, 'f', 0)).
-              arg(Unit::distMeter(distance)));
+    return tr("%1°M, %2").arg(locale.toString(bearing, 'f', 0)).arg(Unit::distMeter(distance));
   }
+  return QString();
 }
 
 void HtmlInfoBuilder::airspaceText(const MapAirspace& airspace, const atools::sql::SqlRecord& onlineRec,
@@ -257,6 +257,10 @@ public:
   void aircraftOnlineText(const atools::fs::sc::SimConnectAircraft& aircraft, const atools::sql::SqlRecord& onlineRec,
                           atools::util::HtmlBuilder& html);
 
+  /* Formatted bearing and distance from user aircraft to pos as shown by the info texts.
+   * Empty if not connected or too far away. Used to detect if a bearing update is needed. */
+  QString bearingAndDistanceTexts(const atools::geo::Pos& pos, float magVar) const;
+
 private:
   void head(atools::util::HtmlBuilder& html, const QString& text) const;
 
@@ -928,6 +928,94 @@ bool MapAirport::noRunways() const
   return !flags.testFlag(AP_HARD) && !flags.testFlag(AP_SOFT) && !flags.testFlag(AP_WATER);
 }
 
+void MapAirportColumns::append(const MapAirport& airport)
+{
+  if(isEmpty())
+  {
+    navdata = airport.navdata;
+    xplane = airport.xplane;
+  }
+  else
+    Q_ASSERT(navdata == airport.navdata && xplane == airport.xplane);
+
+  ids.append(airport.id);
+  positions.append(airport.position);
+  towerCoords.append(airport.towerCoords);
+  boundings.append(airport.bounding);
+  longestRunwayLengths.append(airport.longestRunwayLength);
+  flags.append(airport.flags);
+
+  int regionIndex = regionIndexes.value(airport.region, -1);
+  if(regionIndex == -1)
+  {
+    regionIndex = regions.size();
+    regions.append(airport.region);
+    regionIndexes.insert(airport.region, regionIndex);
+  }
+
+  Details detail;
+  detail.towerFrequency = airport.towerFrequency;
+  detail.atisFrequency = airport.atisFrequency;
+  detail.awosFrequency = airport.awosFrequency;
+  detail.asosFrequency = airport.asosFrequency;
+  detail.unicomFrequency = airport.unicomFrequency;
+  detail.transitionAltitude = airport.transitionAltitude;
+  detail.magvar = airport.magvar;
+  detail.textOffset = text.size();
+  detail.identLength = static_cast<quint16>(airport.ident.size());
+  detail.nameLength = static_cast<quint16>(airport.name.size());
+  detail.regionIndex = static_cast<quint16>(regionIndex);
+  detail.longestRunwayHeading = static_cast<qint16>(airport.longestRunwayHeading);
+  detail.rating = static_cast<qint16>(airport.rating);
+  details.append(detail);
+
+  text.append(airport.ident);
+  text.append(airport.name);
+}
+
+MapAirport MapAirportColumns::airport(int index) const
+{
+  const Details& detail = details.at(index);
+
+  MapAirport ap;
+  ap.id = ids.at(index);
+  ap.ident = text.mid(detail.textOffset, detail.identLength);
+  ap.name = text.mid(detail.textOffset + detail.identLength, detail.nameLength);
+  ap.region = regions.at(detail.regionIndex);
+  ap.longestRunwayLength = longestRunwayLengths.at(index);
+  ap.longestRunwayHeading = detail.longestRunwayHeading;
+  ap.transitionAltitude = detail.transitionAltitude;
+  ap.rating = detail.rating;
+  ap.flags = flags.at(index);
+  ap.magvar = detail.magvar;
+  ap.navdata = navdata;
+  ap.xplane = xplane;
+  ap.towerFrequency = detail.towerFrequency;
+  ap.atisFrequency = detail.atisFrequency;
+  ap.awosFrequency = detail.awosFrequency;
+  ap.asosFrequency = detail.asosFrequency;
+  ap.unicomFrequency = detail.unicomFrequency;
+  ap.position = positions.at(index);
+  ap.towerCoords = towerCoords.at(index);
+  ap.bounding = boundings.at(index);
+  return ap;
+}
+
+void MapAirportColumns::clear()
+{
+  ids.clear();
+  positions.clear();
+  towerCoords.clear();
+  boundings.clear();
+  longestRunwayLengths.clear();
+  flags.clear();
+  details.clear();
+  text.clear();
+  regions.clear();
+  regionIndexes.clear();
+  navdata = xplane = false;
+}
+
 bool MapAirport::isVisible(map::MapObjectTypes objectTypes) const
 {
   if(addon() && objectTypes.testFlag(map::AIRPORT_ADDON))
@@ -30,6 +30,9 @@
 
 #include <QColor>
 #include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QVector>
 
 class OptionData;
 
@@ -174,6 +177,59 @@ struct MapAirport
 
 };
 
+/* Compact columnar cache of airports used instead of a list of MapAirport objects.
+ * Painting and hit-testing iterate the hot columns for positions, flags and runway length. Full MapAirport
+ * objects are created on demand only for airports on the screen or near the cursor.
+ * Ident and name are stored in one shared text buffer and regions are interned to avoid one heap
+ * allocation per string and object. */
+class MapAirportColumns
+{
+public:
+  void append(const map::MapAirport& airport);
+  void clear();
+
+  /* Create a full airport object for the given index */
+  map::MapAirport airport(int index) const;
+
+  int size() const
+  {
+    return ids.size();
+  }
+
+  bool isEmpty() const
+  {
+    return ids.isEmpty();
+  }
+
+  /* Hot columns - same index for all */
+  QVector<int> ids;
+  QVector<atools::geo::Pos> positions, towerCoords;
+  QVector<atools::geo::Rect> boundings;
+  QVector<int> longestRunwayLengths;
+  QVector<map::MapAirportFlags> flags;
+
+private:
+  /* Fields only needed to create full objects */
+  struct Details
+  {
+    int towerFrequency, atisFrequency, awosFrequency, asosFrequency, unicomFrequency, transitionAltitude;
+    float magvar;
+    int textOffset; /* Offset of ident followed by name in text */
+    quint16 identLength, nameLength, regionIndex;
+    qint16 longestRunwayHeading, rating;
+  };
+
+  QVector<Details> details;
+  QString text;
+
+  /* Interned region codes and index of each region in the list */
+  QStringList regions;
+  QHash<QString, int> regionIndexes;
+
+  /* Same for all airports since the cache is filled from one database */
+  bool navdata = false, xplane = false;
+};
+
 /* Airport runway. All dimensions are feet */
 struct MapRunway
 {
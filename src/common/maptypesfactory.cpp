@@ -19,11 +19,15 @@
 
 #include <cmath>
 #include "sql/sqlrecord.h"
+#include "sql/sqlquery.h"
 #include "geo/calculations.h"
 #include "common/maptypes.h"
 
+#include <QDebug>
+
 using namespace atools::geo;
 using atools::sql::SqlRecord;
+using atools::sql::SqlQuery;
 using namespace map;
 
 MapTypesFactory::MapTypesFactory()
@@ -39,38 +43,14 @@ MapTypesFactory::~MapTypesFactory()
 void MapTypesFactory::fillAirport(const SqlRecord& record, map::MapAirport& airport, bool complete, bool nav,
                                   bool xplane)
 {
-  fillAirportBase(record, airport, complete);
-  airport.navdata = nav;
-  airport.xplane = xplane;
-
-  if(complete)
-  {
-    airport.flags = fillAirportFlags(record, false);
-    if(record.contains("has_tower_object"))
-      airport.towerCoords = Pos(record.valueFloat("tower_lonx"), record.valueFloat("tower_laty"));
-
-    airport.atisFrequency = record.valueInt("atis_frequency");
-    airport.awosFrequency = record.valueInt("awos_frequency");
-    airport.asosFrequency = record.valueInt("asos_frequency");
-    airport.unicomFrequency = record.valueInt("unicom_frequency");
-
-    airport.position = Pos(record.valueFloat("lonx"), record.valueFloat("laty"),
-                           record.valueFloat("altitude"));
-
-    airport.region = record.valueStr("region", QString());
-  }
-  else
-    airport.position = Pos(record.valueFloat("lonx"), record.valueFloat("laty"), 0.f);
+  QueryColumns columns;
+  decodeAirport(QueryRow(record), columns, airport, complete ? AIRPORT_FULL : AIRPORT_INCOMPLETE, nav, xplane);
 }
 
 void MapTypesFactory::fillAirportForOverview(const SqlRecord& record, map::MapAirport& airport, bool nav, bool xplane)
 {
-  fillAirportBase(record, airport, true);
-  airport.navdata = nav;
-  airport.xplane = xplane;
-
-  airport.flags = fillAirportFlags(record, true);
-  airport.position = Pos(record.valueFloat("lonx"), record.valueFloat("laty"), 0.f);
+  QueryColumns columns;
+  decodeAirport(QueryRow(record), columns, airport, AIRPORT_OVERVIEW, nav, xplane);
 }
 
 void MapTypesFactory::fillRunway(const atools::sql::SqlRecord& record, map::MapRunway& runway, bool overview)
@@ -127,98 +107,17 @@ void MapTypesFactory::fillRunwayEnd(const atools::sql::SqlRecord& record, MapRun
   end.heading = record.valueFloat("heading");
 }
 
-void MapTypesFactory::fillAirportBase(const SqlRecord& record, map::MapAirport& ap, bool complete)
-{
-  ap.id = record.valueInt("airport_id");
-
-  if(complete)
-  {
-    ap.towerFrequency = record.valueInt("tower_frequency");
-    ap.ident = record.valueStr("ident");
-    ap.name = record.valueStr("name");
-    ap.rating = record.valueInt("rating", -1);
-    ap.longestRunwayLength = record.valueInt("longest_runway_length");
-    ap.longestRunwayHeading = static_cast<int>(std::round(record.valueFloat("longest_runway_heading")));
-    ap.magvar = record.valueFloat("mag_var");
-    ap.transitionAltitude = record.valueInt("transition_altitude", 0);
-
-    ap.bounding = Rect(record.valueFloat("left_lonx"), record.valueFloat("top_laty"),
-                       record.valueFloat("right_lonx"), record.valueFloat("bottom_laty"));
-    ap.flags |= AP_COMPLETE;
-  }
-}
-
-map::MapAirportFlags MapTypesFactory::fillAirportFlags(const SqlRecord& record, bool overview)
-{
-  MapAirportFlags flags = 0;
-  flags |= airportFlag(record, "num_helipad", AP_HELIPAD);
-  flags |= airportFlag(record, "has_avgas", AP_AVGAS);
-  flags |= airportFlag(record, "has_jetfuel", AP_JETFUEL);
-  flags |= airportFlag(record, "tower_frequency", AP_TOWER);
-  flags |= airportFlag(record, "is_closed", AP_CLOSED);
-  flags |= airportFlag(record, "is_military", AP_MIL);
-  flags |= airportFlag(record, "is_addon", AP_ADDON);
-  flags |= airportFlag(record, "is_3d", AP_3D);
-  flags |= airportFlag(record, "num_runway_hard", AP_HARD);
-  flags |= airportFlag(record, "num_runway_soft", AP_SOFT);
-  flags |= airportFlag(record, "num_runway_water", AP_WATER);
-
-  if(!overview)
-  {
-    flags |= airportFlag(record, "num_approach", AP_PROCEDURE);
-    flags |= airportFlag(record, "num_runway_light", AP_LIGHT);
-    flags |= airportFlag(record, "num_runway_end_ils", AP_ILS);
-
-    flags |= airportFlag(record, "num_apron", AP_APRON);
-    flags |= airportFlag(record, "num_taxi_path", AP_TAXIWAY);
-    flags |= airportFlag(record, "has_tower_object", AP_TOWER_OBJ);
-
-    flags |= airportFlag(record, "num_parking_gate", AP_PARKING);
-    flags |= airportFlag(record, "num_parking_ga_ramp", AP_PARKING);
-    flags |= airportFlag(record, "num_parking_cargo", AP_PARKING);
-    flags |= airportFlag(record, "num_parking_mil_cargo", AP_PARKING);
-    flags |= airportFlag(record, "num_parking_mil_combat", AP_PARKING);
-
-    flags |= airportFlag(record, "num_runway_end_vasi", AP_VASI);
-    flags |= airportFlag(record, "num_runway_end_als", AP_ALS);
-    flags |= airportFlag(record, "num_boundary_fence", AP_FENCE);
-    flags |= airportFlag(record, "num_runway_end_closed", AP_RW_CLOSED);
-
-  }
-  else
-  {
-    if(record.valueInt("rating") > 0)
-    {
-      // Force non empty airports for overview results
-      flags |= AP_APRON;
-      flags |= AP_TAXIWAY;
-      flags |= AP_TOWER_OBJ;
-    }
-  }
-
-  return flags;
-}
-
-map::MapAirportFlags MapTypesFactory::airportFlag(const SqlRecord& record, const QString& field,
-                                                  map::MapAirportFlags flag)
-{
-  if(!record.contains(field) || record.isNull(field) || record.valueInt(field) == 0)
-    return AP_NONE;
-  else
-    return flag;
-}
-
 void MapTypesFactory::fillVor(const SqlRecord& record, map::MapVor& vor)
 {
-  fillVorBase(record, vor);
-
-  vor.dmeOnly = record.valueInt("dme_only") > 0;
-  vor.hasDme = !record.isNull("dme_altitude");
+  QueryColumns columns;
+  decodeVor(QueryRow(record), columns, vor);
 }
 
 void MapTypesFactory::fillVorFromNav(const SqlRecord& record, map::MapVor& vor)
 {
-  fillVorBase(record, vor);
+  // Table nav_search has no DME columns - DME flags are set from the navaid type below
+  QueryColumns columns;
+  decodeVor(QueryRow(record), columns, vor);
 
   QString navType = record.valueStr("nav_type");
   if(navType == "TC")
@@ -275,39 +174,6 @@ void MapTypesFactory::fillVorFromNav(const SqlRecord& record, map::MapVor& vor)
   vor.frequency /= 10;
 }
 
-void MapTypesFactory::fillVorBase(const SqlRecord& record, map::MapVor& vor)
-{
-  vor.id = record.valueInt("vor_id");
-  vor.ident = record.valueStr("ident");
-  vor.region = record.valueStr("region");
-  vor.name = atools::capString(record.valueStr("name"));
-
-  // Check also for types from the nav_search table and VORTACs
-  QString type = record.valueStr("type");
-  if(type == "VH" || type == "VTH")
-    vor.type = "H";
-  else if(type == "VL" || type == "VTL")
-    vor.type = "L";
-  else if(type == "VT" || type == "VTT")
-    vor.type = "T";
-  else
-    vor.type = type;
-
-  vor.tacan = type == "TC";
-  vor.vortac = type.startsWith("VT");
-
-  vor.channel = record.valueStr("channel");
-  vor.frequency = record.valueInt("frequency");
-
-  vor.range = record.valueInt("range");
-  vor.magvar = record.valueFloat("mag_var");
-
-  if(record.isNull("altitude"))
-    vor.position = Pos(record.valueFloat("lonx"), record.valueFloat("laty"), INVALID_ALTITUDE_VALUE);
-  else
-    vor.position = Pos(record.valueFloat("lonx"), record.valueFloat("laty"), record.valueFloat("altitude"));
-}
-
 void MapTypesFactory::fillUserdataPoint(const SqlRecord& rec, map::MapUserpoint& obj)
 {
   obj.id = rec.valueInt("userdata_id");
@@ -323,19 +189,8 @@ void MapTypesFactory::fillUserdataPoint(const SqlRecord& rec, map::MapUserpoint&
 
 void MapTypesFactory::fillNdb(const SqlRecord& record, map::MapNdb& ndb)
 {
-  ndb.id = record.valueInt("ndb_id");
-  ndb.ident = record.valueStr("ident");
-  ndb.region = record.valueStr("region");
-  ndb.name = atools::capString(record.valueStr("name"));
-  ndb.type = record.valueStr("type");
-  ndb.frequency = record.valueInt("frequency");
-  ndb.range = record.valueInt("range");
-  ndb.magvar = record.valueFloat("mag_var");
-
-  if(record.isNull("altitude"))
-    ndb.position = Pos(record.valueFloat("lonx"), record.valueFloat("laty"), INVALID_ALTITUDE_VALUE);
-  else
-    ndb.position = Pos(record.valueFloat("lonx"), record.valueFloat("laty"), record.valueFloat("altitude"));
+  QueryColumns columns;
+  decodeNdb(QueryRow(record), columns, ndb);
 }
 
 void MapTypesFactory::fillHelipad(const SqlRecord& record, map::MapHelipad& helipad)
@@ -359,15 +214,8 @@ void MapTypesFactory::fillHelipad(const SqlRecord& record, map::MapHelipad& heli
 
 void MapTypesFactory::fillWaypoint(const SqlRecord& record, map::MapWaypoint& waypoint)
 {
-  waypoint.id = record.valueInt("waypoint_id");
-  waypoint.ident = record.valueStr("ident");
-  waypoint.region = record.valueStr("region");
-  // waypoint.airportIdent = record.valueStr("region");
-  waypoint.type = record.valueStr("type");
-  waypoint.magvar = record.valueFloat("mag_var");
-  waypoint.hasVictorAirways = record.valueInt("num_victor_airway") > 0;
-  waypoint.hasJetAirways = record.valueInt("num_jet_airway") > 0;
-  waypoint.position = Pos(record.valueFloat("lonx"), record.valueFloat("laty"));
+  QueryColumns columns;
+  decodeWaypoint(QueryRow(record), columns, waypoint);
 }
 
 void MapTypesFactory::fillWaypointFromNav(const SqlRecord& record, map::MapWaypoint& waypoint)
@@ -384,76 +232,20 @@ void MapTypesFactory::fillWaypointFromNav(const SqlRecord& record, map::MapWaypo
 
 void MapTypesFactory::fillAirway(const SqlRecord& record, map::MapAirway& airway)
 {
-  airway.id = record.valueInt("airway_id");
-  airway.type = airwayTypeFromString(record.valueStr("airway_type"));
-  airway.name = record.valueStr("airway_name");
-  airway.minAltitude = record.valueInt("minimum_altitude");
-
-  if(record.contains("maximum_altitude"))
-    airway.maxAltitude = record.valueInt("maximum_altitude");
-
-  if(record.contains("direction"))
-  {
-    QString dir = record.valueStr("direction");
-    if(dir == "F")
-      airway.direction = map::DIR_FORWARD;
-    else if(dir == "B")
-      airway.direction = map::DIR_BACKWARD;
-    else
-      // 'N'
-      airway.direction = map::DIR_BOTH;
-  }
-
-  airway.fragment = record.valueInt("airway_fragment_no");
-  airway.sequence = record.valueInt("sequence_no");
-  airway.fromWaypointId = record.valueInt("from_waypoint_id");
-  airway.toWaypointId = record.valueInt("to_waypoint_id");
-  airway.from = Pos(record.valueFloat("from_lonx"), record.valueFloat("from_laty"));
-  airway.to = Pos(record.valueFloat("to_lonx"), record.valueFloat("to_laty"));
-
-  float north = std::max(airway.from.getLatY(), airway.to.getLatY());
-  float south = std::min(airway.from.getLatY(), airway.to.getLatY());
-  float east = std::max(airway.from.getLonX(), airway.to.getLonX());
-  float west = std::min(airway.from.getLonX(), airway.to.getLonX());
-  if(east - west > 180.f)
-    std::swap(east, west);
-  airway.bounding = Rect(west, north, east, south);
+  QueryColumns columns;
+  decodeAirway(QueryRow(record), columns, airway);
 }
 
 void MapTypesFactory::fillMarker(const SqlRecord& record, map::MapMarker& marker)
 {
-  marker.id = record.valueInt("marker_id");
-  marker.type = record.valueStr("type");
-  marker.ident = record.valueStr("ident");
-  marker.heading = static_cast<int>(std::round(record.valueFloat("heading")));
-  marker.position = Pos(record.valueFloat("lonx"),
-                        record.valueFloat("laty"));
+  QueryColumns columns;
+  decodeMarker(QueryRow(record), columns, marker);
 }
 
 void MapTypesFactory::fillIls(const SqlRecord& record, map::MapIls& ils)
 {
-  ils.id = record.valueInt("ils_id");
-  ils.ident = record.valueStr("ident");
-  ils.name = record.valueStr("name");
-  ils.region = record.valueStr("region", QString());
-  ils.heading = record.valueFloat("loc_heading");
-  ils.width = record.isNull("loc_width") ? INVALID_COURSE_VALUE : record.valueFloat("loc_width");
-  ils.magvar = record.valueFloat("mag_var");
-  ils.slope = record.valueFloat("gs_pitch");
-
-  ils.frequency = record.valueInt("frequency");
-  ils.range = record.valueInt("range");
-  ils.hasDme = record.valueInt("dme_range") > 0;
-
-  ils.position = Pos(record.valueFloat("lonx"), record.valueFloat("laty"),
-                     record.valueFloat("altitude"));
-  ils.pos1 = Pos(record.valueFloat("end1_lonx"), record.valueFloat("end1_laty"));
-  ils.pos2 = Pos(record.valueFloat("end2_lonx"), record.valueFloat("end2_laty"));
-  ils.posmid = Pos(record.valueFloat("end_mid_lonx"), record.valueFloat("end_mid_laty"));
-
-  ils.bounding = Rect(ils.position);
-  ils.bounding.extend(ils.pos1);
-  ils.bounding.extend(ils.pos2);
+  QueryColumns columns;
+  decodeIls(QueryRow(record), columns, ils);
 }
 
 void MapTypesFactory::fillParking(const SqlRecord& record, map::MapParking& parking)
@@ -520,3 +312,444 @@ void MapTypesFactory::fillAirspace(const SqlRecord& record, map::MapAirspace& ai
   airspace.bounding = Rect(record.valueFloat("min_lonx"), record.valueFloat("max_laty"),
                            record.valueFloat("max_lonx"), record.valueFloat("min_laty"));
 }
+
+// ==========================================================================================
+// Decoding by column index
+
+QVariant QueryRow::value(int index) const
+{
+  return query != nullptr ? query->value(index) : record->value(index);
+}
+
+SqlRecord QueryRow::getRecord() const
+{
+  return query != nullptr ? query->record() : *record;
+}
+
+void QueryColumns::resolve(const QueryRow& row, const QStringList& names)
+{
+  if(indexes.isEmpty())
+  {
+    SqlRecord rec = row.getRecord();
+    indexes.reserve(names.size());
+    for(const QString& name : names)
+    {
+      bool optional = name.endsWith('?');
+      QString column = optional ? name.left(name.size() - 1) : name;
+
+      int index = rec.contains(column) ? rec.indexOf(column) : -1;
+      if(index == -1 && !optional)
+      {
+        qWarning() << Q_FUNC_INFO << "Mandatory column" << column << "not found";
+        Q_ASSERT_X(false, Q_FUNC_INFO, "Mandatory column not found");
+      }
+      indexes.append(index);
+    }
+  }
+}
+
+bool QueryColumns::isNull(const QueryRow& row, int column) const
+{
+  int index = indexes.at(column);
+  return index == -1 || row.value(index).isNull();
+}
+
+int QueryColumns::valueInt(const QueryRow& row, int column, int defaultValue) const
+{
+  int index = indexes.at(column);
+  return index == -1 ? defaultValue : row.value(index).toInt();
+}
+
+float QueryColumns::valueFloat(const QueryRow& row, int column) const
+{
+  int index = indexes.at(column);
+  return index == -1 ? 0.f : row.value(index).toFloat();
+}
+
+QString QueryColumns::valueStr(const QueryRow& row, int column) const
+{
+  int index = indexes.at(column);
+  return index == -1 ? QString() : row.value(index).toString();
+}
+
+namespace {
+
+/* Airport columns for decoding by index. Order has to match AIRPORT_COLUMNS below. */
+enum AirportColumn
+{
+  AP_COL_ID, AP_COL_TOWER_FREQUENCY, AP_COL_IDENT, AP_COL_NAME, AP_COL_RATING, AP_COL_LONGEST_RUNWAY_LENGTH,
+  AP_COL_LONGEST_RUNWAY_HEADING, AP_COL_MAG_VAR, AP_COL_TRANSITION_ALTITUDE, AP_COL_LEFT_LONX, AP_COL_TOP_LATY,
+  AP_COL_RIGHT_LONX, AP_COL_BOTTOM_LATY, AP_COL_TOWER_LONX, AP_COL_TOWER_LATY, AP_COL_ATIS_FREQUENCY,
+  AP_COL_AWOS_FREQUENCY, AP_COL_ASOS_FREQUENCY, AP_COL_UNICOM_FREQUENCY, AP_COL_LONX, AP_COL_LATY,
+  AP_COL_ALTITUDE, AP_COL_REGION,
+
+  /* Flag columns */
+  AP_COL_NUM_HELIPAD, AP_COL_HAS_AVGAS, AP_COL_HAS_JETFUEL, AP_COL_IS_CLOSED, AP_COL_IS_MILITARY,
+  AP_COL_IS_ADDON, AP_COL_IS_3D, AP_COL_NUM_RUNWAY_HARD, AP_COL_NUM_RUNWAY_SOFT, AP_COL_NUM_RUNWAY_WATER,
+  AP_COL_NUM_APPROACH, AP_COL_NUM_RUNWAY_LIGHT, AP_COL_NUM_RUNWAY_END_ILS, AP_COL_NUM_APRON, AP_COL_NUM_TAXI_PATH,
+  AP_COL_HAS_TOWER_OBJECT, AP_COL_NUM_PARKING_GATE, AP_COL_NUM_PARKING_GA_RAMP, AP_COL_NUM_PARKING_CARGO,
+  AP_COL_NUM_PARKING_MIL_CARGO, AP_COL_NUM_PARKING_MIL_COMBAT, AP_COL_NUM_RUNWAY_END_VASI, AP_COL_NUM_RUNWAY_END_ALS,
+  AP_COL_NUM_BOUNDARY_FENCE, AP_COL_NUM_RUNWAY_END_CLOSED
+};
+
+/* Column is mandatory for incomplete, overview and full airports */
+enum
+{
+  REQ_NONE = 0,
+  REQ_INCOMPLETE = 1 << 0,
+  REQ_OVERVIEW = 1 << 1,
+  REQ_FULL = 1 << 2,
+  REQ_COMPLETE = REQ_OVERVIEW | REQ_FULL,
+  REQ_ALL = REQ_INCOMPLETE | REQ_COMPLETE
+};
+
+const QVector<std::pair<QString, int> > AIRPORT_COLUMNS({
+  {"airport_id", REQ_ALL}, {"tower_frequency", REQ_COMPLETE}, {"ident", REQ_COMPLETE}, {"name", REQ_COMPLETE},
+  {"rating", REQ_NONE}, {"longest_runway_length", REQ_COMPLETE}, {"longest_runway_heading", REQ_COMPLETE},
+  {"mag_var", REQ_COMPLETE}, {"transition_altitude", REQ_NONE}, {"left_lonx", REQ_COMPLETE},
+  {"top_laty", REQ_COMPLETE}, {"right_lonx", REQ_COMPLETE}, {"bottom_laty", REQ_COMPLETE},
+  {"tower_lonx", REQ_NONE}, {"tower_laty", REQ_NONE}, {"atis_frequency", REQ_FULL}, {"awos_frequency", REQ_FULL},
+  {"asos_frequency", REQ_FULL}, {"unicom_frequency", REQ_FULL}, {"lonx", REQ_ALL}, {"laty", REQ_ALL},
+  {"altitude", REQ_FULL}, {"region", REQ_NONE},
+  {"num_helipad", REQ_NONE}, {"has_avgas", REQ_NONE}, {"has_jetfuel", REQ_NONE}, {"is_closed", REQ_NONE},
+  {"is_military", REQ_NONE}, {"is_addon", REQ_NONE}, {"is_3d", REQ_NONE}, {"num_runway_hard", REQ_NONE},
+  {"num_runway_soft", REQ_NONE}, {"num_runway_water", REQ_NONE}, {"num_approach", REQ_NONE},
+  {"num_runway_light", REQ_NONE}, {"num_runway_end_ils", REQ_NONE}, {"num_apron", REQ_NONE},
+  {"num_taxi_path", REQ_NONE}, {"has_tower_object", REQ_NONE}, {"num_parking_gate", REQ_NONE},
+  {"num_parking_ga_ramp", REQ_NONE}, {"num_parking_cargo", REQ_NONE}, {"num_parking_mil_cargo", REQ_NONE},
+  {"num_parking_mil_combat", REQ_NONE}, {"num_runway_end_vasi", REQ_NONE}, {"num_runway_end_als", REQ_NONE},
+  {"num_boundary_fence", REQ_NONE}, {"num_runway_end_closed", REQ_NONE}
+});
+
+/* Column names for QueryColumns::resolve with optional columns marked by "?" */
+QStringList airportColumnNames(int required)
+{
+  QStringList names;
+  for(const std::pair<QString, int>& column : AIRPORT_COLUMNS)
+    names.append((column.second & required) ? column.first : column.first + "?");
+  return names;
+}
+
+/* Flags used for overview and full airports */
+const QVector<std::pair<int, map::MapAirportFlags> > AIRPORT_FLAGS_BASE({
+  {AP_COL_NUM_HELIPAD, AP_HELIPAD}, {AP_COL_HAS_AVGAS, AP_AVGAS}, {AP_COL_HAS_JETFUEL, AP_JETFUEL},
+  {AP_COL_TOWER_FREQUENCY, AP_TOWER}, {AP_COL_IS_CLOSED, AP_CLOSED}, {AP_COL_IS_MILITARY, AP_MIL},
+  {AP_COL_IS_ADDON, AP_ADDON}, {AP_COL_IS_3D, AP_3D}, {AP_COL_NUM_RUNWAY_HARD, AP_HARD},
+  {AP_COL_NUM_RUNWAY_SOFT, AP_SOFT}, {AP_COL_NUM_RUNWAY_WATER, AP_WATER}
+});
+
+/* Flags used for full airports only */
+const QVector<std::pair<int, map::MapAirportFlags> > AIRPORT_FLAGS_FULL({
+  {AP_COL_NUM_APPROACH, AP_PROCEDURE}, {AP_COL_NUM_RUNWAY_LIGHT, AP_LIGHT}, {AP_COL_NUM_RUNWAY_END_ILS, AP_ILS},
+  {AP_COL_NUM_APRON, AP_APRON}, {AP_COL_NUM_TAXI_PATH, AP_TAXIWAY}, {AP_COL_HAS_TOWER_OBJECT, AP_TOWER_OBJ},
+  {AP_COL_NUM_PARKING_GATE, AP_PARKING}, {AP_COL_NUM_PARKING_GA_RAMP, AP_PARKING},
+  {AP_COL_NUM_PARKING_CARGO, AP_PARKING}, {AP_COL_NUM_PARKING_MIL_CARGO, AP_PARKING},
+  {AP_COL_NUM_PARKING_MIL_COMBAT, AP_PARKING}, {AP_COL_NUM_RUNWAY_END_VASI, AP_VASI},
+  {AP_COL_NUM_RUNWAY_END_ALS, AP_ALS}, {AP_COL_NUM_BOUNDARY_FENCE, AP_FENCE},
+  {AP_COL_NUM_RUNWAY_END_CLOSED, AP_RW_CLOSED}
+});
+
+map::MapAirportFlags airportFlags(const QueryRow& row, const QueryColumns& columns,
+                                  const QVector<std::pair<int, map::MapAirportFlags> >& flagColumns)
+{
+  MapAirportFlags flags = 0;
+  for(const std::pair<int, map::MapAirportFlags>& flagColumn : flagColumns)
+  {
+    if(!columns.isNull(row, flagColumn.first) && columns.valueInt(row, flagColumn.first) != 0)
+      flags |= flagColumn.second;
+  }
+  return flags;
+}
+
+}
+
+void MapTypesFactory::decodeAirport(const QueryRow& row, QueryColumns& columns, map::MapAirport& ap,
+                                    AirportDecode mode, bool nav, bool xplane)
+{
+  static const QStringList INCOMPLETE_NAMES = airportColumnNames(REQ_INCOMPLETE);
+  static const QStringList OVERVIEW_NAMES = airportColumnNames(REQ_OVERVIEW);
+  static const QStringList FULL_NAMES = airportColumnNames(REQ_FULL);
+
+  switch(mode)
+  {
+    case AIRPORT_INCOMPLETE:
+      columns.resolve(row, INCOMPLETE_NAMES);
+      break;
+    case AIRPORT_OVERVIEW:
+      columns.resolve(row, OVERVIEW_NAMES);
+      break;
+    case AIRPORT_FULL:
+      columns.resolve(row, FULL_NAMES);
+      break;
+  }
+
+  ap.id = columns.valueInt(row, AP_COL_ID);
+  ap.navdata = nav;
+  ap.xplane = xplane;
+
+  if(mode == AIRPORT_INCOMPLETE)
+  {
+    // Only id and position are present in the record
+    ap.position = Pos(columns.valueFloat(row, AP_COL_LONX), columns.valueFloat(row, AP_COL_LATY), 0.f);
+    return;
+  }
+
+  ap.towerFrequency = columns.valueInt(row, AP_COL_TOWER_FREQUENCY);
+  ap.ident = columns.valueStr(row, AP_COL_IDENT);
+  ap.name = columns.valueStr(row, AP_COL_NAME);
+  ap.rating = columns.valueInt(row, AP_COL_RATING, -1);
+  ap.longestRunwayLength = columns.valueInt(row, AP_COL_LONGEST_RUNWAY_LENGTH);
+  ap.longestRunwayHeading = static_cast<int>(std::round(columns.valueFloat(row, AP_COL_LONGEST_RUNWAY_HEADING)));
+  ap.magvar = columns.valueFloat(row, AP_COL_MAG_VAR);
+  ap.transitionAltitude = columns.valueInt(row, AP_COL_TRANSITION_ALTITUDE);
+
+  ap.bounding = Rect(columns.valueFloat(row, AP_COL_LEFT_LONX), columns.valueFloat(row, AP_COL_TOP_LATY),
+                     columns.valueFloat(row, AP_COL_RIGHT_LONX), columns.valueFloat(row, AP_COL_BOTTOM_LATY));
+  ap.flags |= AP_COMPLETE;
+
+  MapAirportFlags flags = airportFlags(row, columns, AIRPORT_FLAGS_BASE);
+  if(mode == AIRPORT_FULL)
+    flags |= airportFlags(row, columns, AIRPORT_FLAGS_FULL);
+  else if(columns.valueInt(row, AP_COL_RATING) > 0)
+    // Force non empty airports for overview results
+    flags |= AP_APRON | AP_TAXIWAY | AP_TOWER_OBJ;
+  ap.flags = flags;
+
+  if(mode == AIRPORT_FULL)
+  {
+    if(columns.contains(AP_COL_HAS_TOWER_OBJECT))
+      ap.towerCoords = Pos(columns.valueFloat(row, AP_COL_TOWER_LONX), columns.valueFloat(row, AP_COL_TOWER_LATY));
+
+    ap.atisFrequency = columns.valueInt(row, AP_COL_ATIS_FREQUENCY);
+    ap.awosFrequency = columns.valueInt(row, AP_COL_AWOS_FREQUENCY);
+    ap.asosFrequency = columns.valueInt(row, AP_COL_ASOS_FREQUENCY);
+    ap.unicomFrequency = columns.valueInt(row, AP_COL_UNICOM_FREQUENCY);
+
+    ap.position = Pos(columns.valueFloat(row, AP_COL_LONX), columns.valueFloat(row, AP_COL_LATY),
+                      columns.valueFloat(row, AP_COL_ALTITUDE));
+
+    ap.region = columns.valueStr(row, AP_COL_REGION);
+  }
+  else
+    ap.position = Pos(columns.valueFloat(row, AP_COL_LONX), columns.valueFloat(row, AP_COL_LATY), 0.f);
+}
+
+void MapTypesFactory::fillAirport(SqlQuery *query, QueryColumns& columns, map::MapAirport& airport, bool nav,
+                                  bool xplane)
+{
+  decodeAirport(QueryRow(query), columns, airport, AIRPORT_FULL, nav, xplane);
+}
+
+void MapTypesFactory::fillAirportForOverview(SqlQuery *query, QueryColumns& columns, map::MapAirport& airport,
+                                             bool nav, bool xplane)
+{
+  decodeAirport(QueryRow(query), columns, airport, AIRPORT_OVERVIEW, nav, xplane);
+}
+
+void MapTypesFactory::decodeVor(const QueryRow& row, QueryColumns& columns, map::MapVor& vor)
+{
+  enum {ID, IDENT, REGION, NAME, TYPE, CHANNEL, FREQUENCY, RANGE, MAG_VAR, ALTITUDE, LONX, LATY, DME_ONLY,
+        DME_ALTITUDE};
+  static const QStringList NAMES({"vor_id", "ident", "region", "name", "type", "channel", "frequency", "range",
+                                  "mag_var", "altitude?", "lonx", "laty", "dme_only?", "dme_altitude?"});
+  columns.resolve(row, NAMES);
+
+  vor.id = columns.valueInt(row, ID);
+  vor.ident = columns.valueStr(row, IDENT);
+  vor.region = columns.valueStr(row, REGION);
+  vor.name = atools::capString(columns.valueStr(row, NAME));
+
+  // Check also for types from the nav_search table and VORTACs
+  QString type = columns.valueStr(row, TYPE);
+  if(type == "VH" || type == "VTH")
+    vor.type = "H";
+  else if(type == "VL" || type == "VTL")
+    vor.type = "L";
+  else if(type == "VT" || type == "VTT")
+    vor.type = "T";
+  else
+    vor.type = type;
+
+  vor.tacan = type == "TC";
+  vor.vortac = type.startsWith("VT");
+
+  vor.channel = columns.valueStr(row, CHANNEL);
+  vor.frequency = columns.valueInt(row, FREQUENCY);
+  vor.range = columns.valueInt(row, RANGE);
+  vor.magvar = columns.valueFloat(row, MAG_VAR);
+
+  if(columns.isNull(row, ALTITUDE))
+    vor.position = Pos(columns.valueFloat(row, LONX), columns.valueFloat(row, LATY), INVALID_ALTITUDE_VALUE);
+  else
+    vor.position = Pos(columns.valueFloat(row, LONX), columns.valueFloat(row, LATY),
+                       columns.valueFloat(row, ALTITUDE));
+
+  // DME columns are only present in table vor
+  if(columns.contains(DME_ONLY))
+    vor.dmeOnly = columns.valueInt(row, DME_ONLY) > 0;
+  if(columns.contains(DME_ALTITUDE))
+    vor.hasDme = !columns.isNull(row, DME_ALTITUDE);
+}
+
+void MapTypesFactory::fillVor(SqlQuery *query, QueryColumns& columns, map::MapVor& vor)
+{
+  decodeVor(QueryRow(query), columns, vor);
+}
+
+void MapTypesFactory::decodeNdb(const QueryRow& row, QueryColumns& columns, map::MapNdb& ndb)
+{
+  enum {ID, IDENT, REGION, NAME, TYPE, FREQUENCY, RANGE, MAG_VAR, ALTITUDE, LONX, LATY};
+  static const QStringList NAMES({"ndb_id", "ident", "region", "name", "type", "frequency", "range", "mag_var",
+                                  "altitude?", "lonx", "laty"});
+  columns.resolve(row, NAMES);
+
+  ndb.id = columns.valueInt(row, ID);
+  ndb.ident = columns.valueStr(row, IDENT);
+  ndb.region = columns.valueStr(row, REGION);
+  ndb.name = atools::capString(columns.valueStr(row, NAME));
+  ndb.type = columns.valueStr(row, TYPE);
+  ndb.frequency = columns.valueInt(row, FREQUENCY);
+  ndb.range = columns.valueInt(row, RANGE);
+  ndb.magvar = columns.valueFloat(row, MAG_VAR);
+
+  if(columns.isNull(row, ALTITUDE))
+    ndb.position = Pos(columns.valueFloat(row, LONX), columns.valueFloat(row, LATY), INVALID_ALTITUDE_VALUE);
+  else
+    ndb.position = Pos(columns.valueFloat(row, LONX), columns.valueFloat(row, LATY),
+                       columns.valueFloat(row, ALTITUDE));
+}
+
+void MapTypesFactory::fillNdb(SqlQuery *query, QueryColumns& columns, map::MapNdb& ndb)
+{
+  decodeNdb(QueryRow(query), columns, ndb);
+}
+
+void MapTypesFactory::decodeWaypoint(const QueryRow& row, QueryColumns& columns, map::MapWaypoint& waypoint)
+{
+  enum {ID, IDENT, REGION, TYPE, MAG_VAR, NUM_VICTOR_AIRWAY, NUM_JET_AIRWAY, LONX, LATY};
+  static const QStringList NAMES({"waypoint_id", "ident", "region", "type", "mag_var", "num_victor_airway",
+                                  "num_jet_airway", "lonx", "laty"});
+  columns.resolve(row, NAMES);
+
+  waypoint.id = columns.valueInt(row, ID);
+  waypoint.ident = columns.valueStr(row, IDENT);
+  waypoint.region = columns.valueStr(row, REGION);
+  waypoint.type = columns.valueStr(row, TYPE);
+  waypoint.magvar = columns.valueFloat(row, MAG_VAR);
+  waypoint.hasVictorAirways = columns.valueInt(row, NUM_VICTOR_AIRWAY) > 0;
+  waypoint.hasJetAirways = columns.valueInt(row, NUM_JET_AIRWAY) > 0;
+  waypoint.position = Pos(columns.valueFloat(row, LONX), columns.valueFloat(row, LATY));
+}
+
+void MapTypesFactory::fillWaypoint(SqlQuery *query, QueryColumns& columns, map::MapWaypoint& waypoint)
+{
+  decodeWaypoint(QueryRow(query), columns, waypoint);
+}
+
+void MapTypesFactory::decodeAirway(const QueryRow& row, QueryColumns& columns, map::MapAirway& airway)
+{
+  enum {ID, TYPE, NAME, MIN_ALTITUDE, MAX_ALTITUDE, DIRECTION, FRAGMENT, SEQUENCE, FROM_ID, TO_ID,
+        FROM_LONX, FROM_LATY, TO_LONX, TO_LATY};
+  static const QStringList NAMES({"airway_id", "airway_type", "airway_name", "minimum_altitude",
+                                  "maximum_altitude?", "direction?", "airway_fragment_no", "sequence_no",
+                                  "from_waypoint_id", "to_waypoint_id", "from_lonx", "from_laty", "to_lonx",
+                                  "to_laty"});
+  columns.resolve(row, NAMES);
+
+  airway.id = columns.valueInt(row, ID);
+  airway.type = airwayTypeFromString(columns.valueStr(row, TYPE));
+  airway.name = columns.valueStr(row, NAME);
+  airway.minAltitude = columns.valueInt(row, MIN_ALTITUDE);
+
+  if(columns.contains(MAX_ALTITUDE))
+    airway.maxAltitude = columns.valueInt(row, MAX_ALTITUDE);
+
+  if(columns.contains(DIRECTION))
+  {
+    QString dir = columns.valueStr(row, DIRECTION);
+    if(dir == "F")
+      airway.direction = map::DIR_FORWARD;
+    else if(dir == "B")
+      airway.direction = map::DIR_BACKWARD;
+    else
+      // 'N'
+      airway.direction = map::DIR_BOTH;
+  }
+
+  airway.fragment = columns.valueInt(row, FRAGMENT);
+  airway.sequence = columns.valueInt(row, SEQUENCE);
+  airway.fromWaypointId = columns.valueInt(row, FROM_ID);
+  airway.toWaypointId = columns.valueInt(row, TO_ID);
+  airway.from = Pos(columns.valueFloat(row, FROM_LONX), columns.valueFloat(row, FROM_LATY));
+  airway.to = Pos(columns.valueFloat(row, TO_LONX), columns.valueFloat(row, TO_LATY));
+
+  float north = std::max(airway.from.getLatY(), airway.to.getLatY());
+  float south = std::min(airway.from.getLatY(), airway.to.getLatY());
+  float east = std::max(airway.from.getLonX(), airway.to.getLonX());
+  float west = std::min(airway.from.getLonX(), airway.to.getLonX());
+  if(east - west > 180.f)
+    std::swap(east, west);
+  airway.bounding = Rect(west, north, east, south);
+}
+
+void MapTypesFactory::fillAirway(SqlQuery *query, QueryColumns& columns, map::MapAirway& airway)
+{
+  decodeAirway(QueryRow(query), columns, airway);
+}
+
+void MapTypesFactory::decodeMarker(const QueryRow& row, QueryColumns& columns, map::MapMarker& marker)
+{
+  enum {ID, TYPE, IDENT, HEADING, LONX, LATY};
+  static const QStringList NAMES({"marker_id", "type", "ident", "heading", "lonx", "laty"});
+  columns.resolve(row, NAMES);
+
+  marker.id = columns.valueInt(row, ID);
+  marker.type = columns.valueStr(row, TYPE);
+  marker.ident = columns.valueStr(row, IDENT);
+  marker.heading = static_cast<int>(std::round(columns.valueFloat(row, HEADING)));
+  marker.position = Pos(columns.valueFloat(row, LONX), columns.valueFloat(row, LATY));
+}
+
+void MapTypesFactory::fillMarker(SqlQuery *query, QueryColumns& columns, map::MapMarker& marker)
+{
+  decodeMarker(QueryRow(query), columns, marker);
+}
+
+void MapTypesFactory::decodeIls(const QueryRow& row, QueryColumns& columns, map::MapIls& ils)
+{
+  enum {ID, IDENT, NAME, REGION, LOC_HEADING, LOC_WIDTH, MAG_VAR, GS_PITCH, FREQUENCY, RANGE, DME_RANGE,
+        LONX, LATY, ALTITUDE, END1_LONX, END1_LATY, END2_LONX, END2_LATY, END_MID_LONX, END_MID_LATY};
+  static const QStringList NAMES({"ils_id", "ident", "name", "region?", "loc_heading", "loc_width?", "mag_var",
+                                  "gs_pitch", "frequency", "range", "dme_range", "lonx", "laty", "altitude",
+                                  "end1_lonx", "end1_laty", "end2_lonx", "end2_laty", "end_mid_lonx",
+                                  "end_mid_laty"});
+  columns.resolve(row, NAMES);
+
+  ils.id = columns.valueInt(row, ID);
+  ils.ident = columns.valueStr(row, IDENT);
+  ils.name = columns.valueStr(row, NAME);
+  ils.region = columns.valueStr(row, REGION);
+  ils.heading = columns.valueFloat(row, LOC_HEADING);
+  ils.width = columns.isNull(row, LOC_WIDTH) ? INVALID_COURSE_VALUE : columns.valueFloat(row, LOC_WIDTH);
+  ils.magvar = columns.valueFloat(row, MAG_VAR);
+  ils.slope = columns.valueFloat(row, GS_PITCH);
+
+  ils.frequency = columns.valueInt(row, FREQUENCY);
+  ils.range = columns.valueInt(row, RANGE);
+  ils.hasDme = columns.valueInt(row, DME_RANGE) > 0;
+
+  ils.position = Pos(columns.valueFloat(row, LONX), columns.valueFloat(row, LATY),
+                     columns.valueFloat(row, ALTITUDE));
+  ils.pos1 = Pos(columns.valueFloat(row, END1_LONX), columns.valueFloat(row, END1_LATY));
+  ils.pos2 = Pos(columns.valueFloat(row, END2_LONX), columns.valueFloat(row, END2_LATY));
+  ils.posmid = Pos(columns.valueFloat(row, END_MID_LONX), columns.valueFloat(row, END_MID_LATY));
+
+  ils.bounding = Rect(ils.position);
+  ils.bounding.extend(ils.pos1);
+  ils.bounding.extend(ils.pos2);
+}
+
+void MapTypesFactory::fillIls(SqlQuery *query, QueryColumns& columns, map::MapIls& ils)
+{
+  decodeIls(QueryRow(query), columns, ils);
+}
@@ -20,10 +20,15 @@
 
 #include "common/mapflags.h"
 
+#include <QStringList>
+#include <QVariant>
+#include <QVector>
+
 namespace atools {
 namespace sql {
 
 class SqlRecord;
+class SqlQuery;
 }
 }
 
@@ -58,6 +63,66 @@ struct MapUserpoint;
 
 }
 
+/*
+ * Current row of a query cursor or a single record. Allows to decode both by column index using the same code.
+ */
+class QueryRow
+{
+public:
+  explicit QueryRow(atools::sql::SqlQuery *queryParam)
+    : query(queryParam)
+  {
+  }
+
+  explicit QueryRow(const atools::sql::SqlRecord& recordParam)
+    : record(&recordParam)
+  {
+  }
+
+  QVariant value(int index) const;
+
+  /* Used to resolve column names */
+  atools::sql::SqlRecord getRecord() const;
+
+private:
+  atools::sql::SqlQuery *query = nullptr;
+  const atools::sql::SqlRecord *record = nullptr;
+};
+
+/*
+ * Column indexes of a query resolved from the first row and reused for all following rows.
+ * Allows to decode rows directly from the cursor by index without copying a SqlRecord and looking up
+ * each field by name.
+ * Names ending with "?" are optional. Missing optional columns have index -1 and return default values.
+ * A missing mandatory column is an error and triggers an assertion.
+ * Call reset() if the query is prepared again.
+ */
+class QueryColumns
+{
+public:
+  /* Resolve indexes for the given column names if not already done */
+  void resolve(const QueryRow& row, const QStringList& names);
+
+  void reset()
+  {
+    indexes.clear();
+  }
+
+  /* true if the column is part of the query */
+  bool contains(int column) const
+  {
+    return indexes.at(column) != -1;
+  }
+
+  bool isNull(const QueryRow& row, int column) const;
+  int valueInt(const QueryRow& row, int column, int defaultValue = 0) const;
+  float valueFloat(const QueryRow& row, int column) const;
+  QString valueStr(const QueryRow& row, int column) const;
+
+private:
+  QVector<int> indexes;
+};
+
 /*
  * Create all map objects (namespace maptypes) from sql records. The sql records can be
  * a result from sql queries or manually built.
@@ -107,14 +172,38 @@ public:
 
   void fillUserdataPoint(const atools::sql::SqlRecord& rec, map::MapUserpoint& obj);
 
-private:
-  void fillVorBase(const atools::sql::SqlRecord& record, map::MapVor& vor);
-
-  void fillAirportBase(const atools::sql::SqlRecord& record, map::MapAirport& ap, bool complete);
+  /* Same as the methods above but decode the current row of the query by column index.
+   * The columns object has to be kept for the lifetime of the prepared query.
+   * The record based methods use the same decoders with temporary columns. */
+  void fillAirport(atools::sql::SqlQuery *query, QueryColumns& columns, map::MapAirport& airport, bool nav,
+                   bool xplane);
+  void fillAirportForOverview(atools::sql::SqlQuery *query, QueryColumns& columns, map::MapAirport& airport,
+                              bool nav, bool xplane);
+  void fillVor(atools::sql::SqlQuery *query, QueryColumns& columns, map::MapVor& vor);
+  void fillNdb(atools::sql::SqlQuery *query, QueryColumns& columns, map::MapNdb& ndb);
+  void fillWaypoint(atools::sql::SqlQuery *query, QueryColumns& columns, map::MapWaypoint& waypoint);
+  void fillAirway(atools::sql::SqlQuery *query, QueryColumns& columns, map::MapAirway& airway);
+  void fillMarker(atools::sql::SqlQuery *query, QueryColumns& columns, map::MapMarker& marker);
+  void fillIls(atools::sql::SqlQuery *query, QueryColumns& columns, map::MapIls& ils);
 
-  map::MapAirportFlags airportFlag(const atools::sql::SqlRecord& record, const QString& field,
-                                   map::MapAirportFlags airportFlag);
-  map::MapAirportFlags fillAirportFlags(const atools::sql::SqlRecord& record, bool overview);
+private:
+  /* Decides which columns are read and mandatory */
+  enum AirportDecode
+  {
+    AIRPORT_INCOMPLETE, /* Only id and position */
+    AIRPORT_OVERVIEW, /* Tables airport_medium and airport_large */
+    AIRPORT_FULL /* Table airport */
+  };
+
+  /* One decoder for each type used by the record and the query based methods */
+  void decodeAirport(const QueryRow& row, QueryColumns& columns, map::MapAirport& ap, AirportDecode mode,
+                     bool nav, bool xplane);
+  void decodeVor(const QueryRow& row, QueryColumns& columns, map::MapVor& vor);
+  void decodeNdb(const QueryRow& row, QueryColumns& columns, map::MapNdb& ndb);
+  void decodeWaypoint(const QueryRow& row, QueryColumns& columns, map::MapWaypoint& waypoint);
+  void decodeAirway(const QueryRow& row, QueryColumns& columns, map::MapAirway& airway);
+  void decodeMarker(const QueryRow& row, QueryColumns& columns, map::MapMarker& marker);
+  void decodeIls(const QueryRow& row, QueryColumns& columns, map::MapIls& ils);
 
 };
 
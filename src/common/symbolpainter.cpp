@@ -28,6 +28,8 @@
 #include "fs/weather/metarparser.h"
 
 #include <QPainter>
+#include <QPaintDevice>
+#include <QStringBuilder>
 #include <QApplication>
 #include <marble/GeoPainter.h>
 
@@ -41,8 +43,37 @@ const QVector<QLine> AIRCRAFTLINES({QLine(0, -20, 0, 16), // Body
                                     QLine(-10, 18, 0, 14), QLine(0, 14, 10, 18) // Horizontal stabilizer
                                    });
 
-SymbolPainter::SymbolPainter()
+/* Symbols larger than this are always drawn as vectors */
+static const int MAX_ATLAS_SYMBOL_SIZE = 128;
+
+/* Atlas cost is kilobytes of pixmap memory */
+static const int MAX_ATLAS_COST_KB = 4096;
+
+/* Symbol kinds for atlas key */
+static const quint64 ATLAS_AIRPORT = 0, ATLAS_VOR = 1, ATLAS_NDB = 2, ATLAS_WAYPOINT = 3;
+
+/* First bit used by symbol specific flags in atlas key */
+static const int ATLAS_FLAG_SHIFT = 20;
+
+/* Runway heading in airport symbols is rounded to this value */
+static const float ATLAS_HEADING_STEP = 5.f;
+
+/* Number of cached text box layouts and sizes */
+static const int MAX_TEXT_LAYOUTS = 2000;
+
+int SymbolPainter::globalAtlasGeneration = 0;
+
+SymbolPainter::SymbolPainter(bool useAtlas)
+  : atlasEnabled(useAtlas)
+{
+  symbolAtlas.setMaxCost(MAX_ATLAS_COST_KB);
+  textLayouts.setMaxCost(MAX_TEXT_LAYOUTS);
+  textBoxSizes.setMaxCost(MAX_TEXT_LAYOUTS);
+}
+
+void SymbolPainter::invalidateSymbolAtlas()
 {
+  globalAtlasGeneration++;
 }
 
 SymbolPainter::~SymbolPainter()
@@ -145,6 +176,39 @@ QIcon SymbolPainter::createAirspaceIcon(const map::MapAirspace& airspace, int si
 void SymbolPainter::drawAirportSymbol(QPainter *painter, const map::MapAirport& airport,
                                       float x, float y, int size, bool isAirportDiagram, bool fast)
 {
+  if(atlasEnabled)
+  {
+    bool detail = (!fast || isAirportDiagram) && size > 5;
+
+    // Runway heading line is only drawn for detailed hard surface airports - line is symmetric
+    int headingBucket = 0;
+    if(detail && airport.flags.testFlag(AP_HARD) && !airport.flags.testFlag(AP_MIL) &&
+       !airport.flags.testFlag(AP_CLOSED))
+      headingBucket = atools::roundToInt(std::fmod(airport.longestRunwayHeading, 180.f) / ATLAS_HEADING_STEP) %
+                      atools::roundToInt(180.f / ATLAS_HEADING_STEP);
+
+    quint64 flags = (isAirportDiagram ? 0x01 : 0) |
+                    (airport.flags.testFlag(AP_HARD) ? 0x02 : 0) |
+                    (airport.flags.testFlag(AP_MIL) ? 0x04 : 0) |
+                    (airport.flags.testFlag(AP_CLOSED) ? 0x08 : 0) |
+                    (airport.anyFuel() ? 0x10 : 0) |
+                    (airport.waterOnly() ? 0x20 : 0) |
+                    (airport.helipadOnly() ? 0x40 : 0) |
+                    (airport.longestRunwayLength == 0 && !airport.helipad() ? 0x80 : 0) |
+                    (airport.emptyDraw() ? 0x100 : 0) |
+                    (airport.tower() ? 0x200 : 0) |
+                    (static_cast<quint64>(headingBucket) << 10);
+
+    if(drawFromAtlas(painter, x, y, atlasBaseKey(painter, ATLAS_AIRPORT, size, fast) | (flags << ATLAS_FLAG_SHIFT),
+                      size + 4, [&airport, headingBucket, size, isAirportDiagram, fast](QPainter *pxPainter,
+                                                                                         int center) {
+      map::MapAirport ap(airport);
+      ap.longestRunwayHeading = headingBucket * ATLAS_HEADING_STEP;
+      SymbolPainter().drawAirportSymbol(pxPainter, ap, center, center, size, isAirportDiagram, fast);
+    }))
+      return;
+  }
+
   float symsize = atools::roundToInt(size);
 
   if(airport.longestRunwayLength == 0 && !airport.helipad())
@@ -242,6 +306,17 @@ void SymbolPainter::drawAirportSymbol(QPainter *painter, const map::MapAirport&
 void SymbolPainter::drawWaypointSymbol(QPainter *painter, const QColor& col, int x, int y, int size,
                                        bool fill, bool fast)
 {
+  if(atlasEnabled)
+  {
+    quint64 flags = (fill ? 0x01 : 0) | (col.isValid() ? static_cast<quint64>(col.rgba()) << 1 : 0);
+
+    if(drawFromAtlas(painter, x, y, atlasBaseKey(painter, ATLAS_WAYPOINT, size, fast) | (flags << ATLAS_FLAG_SHIFT),
+                      size / 2 + 6, [&col, size, fill, fast](QPainter *pxPainter, int center) {
+      SymbolPainter().drawWaypointSymbol(pxPainter, col, center, center, size, fill, fast);
+    }))
+      return;
+  }
+
   atools::util::PainterContextSaver saver(painter);
   painter->setBackgroundMode(Qt::TransparentMode);
   if(fill)
@@ -629,6 +704,22 @@ void SymbolPainter::drawAircraftSymbol(QPainter *painter, int x, int y, int size
 void SymbolPainter::drawVorSymbol(QPainter *painter, const map::MapVor& vor, int x, int y, int size,
                                   bool routeFill, bool fast, int largeSize)
 {
+  // Symbols with compass rose are rotated by magnetic variation and are not cached
+  if(atlasEnabled && (fast || largeSize <= 0 || vor.dmeOnly))
+  {
+    quint64 flags = (routeFill ? 0x01 : 0) |
+                    (vor.tacan ? 0x02 : 0) |
+                    (vor.vortac ? 0x04 : 0) |
+                    (vor.hasDme ? 0x08 : 0) |
+                    (vor.dmeOnly ? 0x10 : 0);
+
+    if(drawFromAtlas(painter, x, y, atlasBaseKey(painter, ATLAS_VOR, size, fast) | (flags << ATLAS_FLAG_SHIFT),
+                      size / 2 + 6, [&vor, size, routeFill, fast](QPainter *pxPainter, int center) {
+      SymbolPainter().drawVorSymbol(pxPainter, vor, center, center, size, routeFill, fast, 0);
+    }))
+      return;
+  }
+
   atools::util::PainterContextSaver saver(painter);
   Q_UNUSED(saver);
 
@@ -768,6 +859,17 @@ void SymbolPainter::drawVorSymbol(QPainter *painter, const map::MapVor& vor, int
 
 void SymbolPainter::drawNdbSymbol(QPainter *painter, int x, int y, int size, bool routeFill, bool fast)
 {
+  if(atlasEnabled)
+  {
+    quint64 flags = routeFill ? 0x01 : 0;
+
+    if(drawFromAtlas(painter, x, y, atlasBaseKey(painter, ATLAS_NDB, size, fast) | (flags << ATLAS_FLAG_SHIFT),
+                      size / 2 + 6, [size, routeFill, fast](QPainter *pxPainter, int center) {
+      SymbolPainter().drawNdbSymbol(pxPainter, center, center, size, routeFill, fast);
+    }))
+      return;
+  }
+
   atools::util::PainterContextSaver saver(painter);
   float sizeF = static_cast<float>(size);
 
@@ -1040,39 +1142,36 @@ void SymbolPainter::textBoxF(QPainter *painter, const QStringList& texts, const
     painter->setBackground(backColor);
   }
 
-  if(atts.testFlag(textatt::ITALIC) || atts.testFlag(textatt::BOLD) || atts.testFlag(textatt::UNDERLINE) ||
-     atts.testFlag(textatt::OVERLINE))
-  {
-    QFont f = painter->font();
-    f.setBold(atts.testFlag(textatt::BOLD));
-    f.setItalic(atts.testFlag(textatt::ITALIC));
-    f.setUnderline(atts.testFlag(textatt::UNDERLINE));
-    f.setOverline(atts.testFlag(textatt::OVERLINE));
-    painter->setFont(f);
-  }
+  setTextBoxFont(painter, atts);
+
+  // Get text metrics and shaped lines from cache
+  const TextBoxLayout *layout = textBoxLayout(painter, texts, atts);
+  bool fillBackground = painter->backgroundMode() == Qt::OpaqueMode;
 
-  // Draw the text
-  QFontMetricsF metrics = painter->fontMetrics();
-  float h = static_cast<float>(metrics.height()) - 1.f;
-  float yoffset = (texts.size() * h) / 2.f - static_cast<float>(metrics.descent());
+  // Background is drawn explicitly since static text ignores the background mode
+  painter->setBackgroundMode(Qt::TransparentMode);
+  float yoffset = (texts.size() * layout->lineHeight) / 2.f - layout->descent;
   painter->setPen(textPen);
 
   // Draw text in reverse order to avoid undercut
   for(int i = texts.size() - 1; i >= 0; i--)
   {
-    const QString& text = texts.at(i);
-    if(text.isEmpty())
+    if(texts.at(i).isEmpty())
       continue;
 
-    float w = static_cast<float>(metrics.width(text));
+    float w = layout->widths.at(i);
     float newx = x;
     if(atts.testFlag(textatt::RIGHT))
       newx -= w;
     else if(atts.testFlag(textatt::CENTER))
       newx -= w / 2.f;
 
-    painter->drawText(QPointF(newx, y + yoffset), text);
-    yoffset -= h;
+    float top = y + yoffset - layout->ascent;
+    if(fillBackground)
+      painter->fillRect(QRectF(newx, top, w, layout->ascent + layout->descent), backColor);
+
+    painter->drawStaticText(QPointF(newx, top), layout->lines.at(i));
+    yoffset -= layout->lineHeight;
   }
 }
 
@@ -1083,15 +1182,12 @@ QRect SymbolPainter::textBoxSize(QPainter *painter, const QStringList& texts, te
     return retval;
 
   atools::util::PainterContextSaver saver(painter);
+  setTextBoxFont(painter, atts & ~textatt::OVERLINE);
 
-  if(atts.testFlag(textatt::ITALIC) || atts.testFlag(textatt::BOLD) || atts.testFlag(textatt::UNDERLINE))
-  {
-    QFont f = painter->font();
-    f.setBold(atts.testFlag(textatt::BOLD));
-    f.setItalic(atts.testFlag(textatt::ITALIC));
-    f.setUnderline(atts.testFlag(textatt::UNDERLINE));
-    painter->setFont(f);
-  }
+  QString key = textLayoutKey(painter, texts, atts);
+  const QRect *cachedRect = textBoxSizes.object(key);
+  if(cachedRect != nullptr)
+    return *cachedRect;
 
   QFontMetrics metrics = painter->fontMetrics();
   int h = metrics.height();
@@ -1107,17 +1203,81 @@ QRect SymbolPainter::textBoxSize(QPainter *painter, const QStringList& texts, te
     else if(atts.testFlag(textatt::CENTER))
       newx -= w / 2;
 
-    int textW = metrics.width(t);
     if(retval.isNull())
-      retval = QRect(newx, yoffset, textW, h);
+      retval = QRect(newx, yoffset, w, h);
     else
-      retval = retval.united(QRect(newx, yoffset, textW, h));
-    // painter->drawText(newx, y + yoffset, t);
+      retval = retval.united(QRect(newx, yoffset, w, h));
     yoffset += h;
   }
+
+  textBoxSizes.insert(key, new QRect(retval));
   return retval;
 }
 
+void SymbolPainter::setTextBoxFont(QPainter *painter, textatt::TextAttributes atts) const
+{
+  if(atts.testFlag(textatt::ITALIC) || atts.testFlag(textatt::BOLD) || atts.testFlag(textatt::UNDERLINE) ||
+     atts.testFlag(textatt::OVERLINE))
+  {
+    QFont f = painter->font();
+    f.setBold(atts.testFlag(textatt::BOLD));
+    f.setItalic(atts.testFlag(textatt::ITALIC));
+    f.setUnderline(atts.testFlag(textatt::UNDERLINE));
+    f.setOverline(atts.testFlag(textatt::OVERLINE));
+    painter->setFont(f);
+  }
+}
+
+QString SymbolPainter::textLayoutKey(const QPainter *painter, const QStringList& texts,
+                                     textatt::TextAttributes atts) const
+{
+  // Background color attributes do not change layout or size
+  int fontAtts = static_cast<int>(atts & (textatt::BOLD | textatt::ITALIC | textatt::UNDERLINE |
+                                          textatt::OVERLINE | textatt::RIGHT | textatt::CENTER));
+
+  // Metrics depend on the resolution of the paint device, e.g. screen, printer or image export
+  QString dpi;
+  const QPaintDevice *device = painter->device();
+  if(device != nullptr)
+    dpi = QString::number(device->logicalDpiX()) % QChar('x') % QString::number(device->logicalDpiY());
+
+  return painter->font().key() % QChar('\x1f') % dpi % QChar('\x1f') % QString::number(fontAtts) %
+         QChar('\x1f') % texts.join(QChar('\n'));
+}
+
+const SymbolPainter::TextBoxLayout *SymbolPainter::textBoxLayout(QPainter *painter, const QStringList& texts,
+                                                                 textatt::TextAttributes atts)
+{
+  QString key = textLayoutKey(painter, texts, atts);
+  const TextBoxLayout *layout = textLayouts.object(key);
+
+  if(layout == nullptr)
+  {
+    const QFont& font = painter->font();
+    QFontMetricsF metrics(font, painter->device());
+
+    TextBoxLayout *newLayout = new TextBoxLayout;
+    newLayout->lineHeight = static_cast<float>(metrics.height()) - 1.f;
+    newLayout->ascent = static_cast<float>(metrics.ascent());
+    newLayout->descent = static_cast<float>(metrics.descent());
+
+    for(const QString& text : texts)
+    {
+      QStaticText staticText(text);
+      staticText.setTextFormat(Qt::PlainText);
+      staticText.setPerformanceHint(QStaticText::AggressiveCaching);
+      staticText.prepare(QTransform(), font);
+
+      newLayout->lines.append(staticText);
+      newLayout->widths.append(static_cast<float>(metrics.width(text)));
+    }
+
+    textLayouts.insert(key, newLayout);
+    layout = newLayout;
+  }
+  return layout;
+}
+
 const QPixmap *SymbolPainter::windPointerFromCache(int size)
 {
   if(windPointerPixmaps.contains(size))
@@ -1144,6 +1304,56 @@ const QPixmap *SymbolPainter::trackLineFromCache(int size)
   }
 }
 
+quint64 SymbolPainter::atlasBaseKey(QPainter *painter, quint64 kind, int size, bool fast) const
+{
+  // Pixel ratio in steps of 1/8 - needed for high DPI screens
+  quint64 ratio = static_cast<quint64>(atools::roundToInt(painter->device()->devicePixelRatioF() * 8.)) & 0x3f;
+
+  return kind |
+         (static_cast<quint64>(size) & 0x3ff) << 2 |
+         (fast ? 1ull << 12 : 0) |
+         (painter->testRenderHint(QPainter::Antialiasing) ? 1ull << 13 : 0) |
+         ratio << 14;
+}
+
+bool SymbolPainter::drawFromAtlas(QPainter *painter, float x, float y, quint64 key, int halfSize,
+                                  const std::function<void(QPainter *painter, int center)>& drawFunc)
+{
+  if(halfSize > MAX_ATLAS_SYMBOL_SIZE || halfSize <= 0)
+    return false;
+
+  if(atlasGeneration != globalAtlasGeneration)
+  {
+    // Colors or style changed - drop all
+    symbolAtlas.clear();
+    atlasGeneration = globalAtlasGeneration;
+  }
+
+  const QPixmap *pixmap = symbolAtlas.object(key);
+  if(pixmap == nullptr)
+  {
+    qreal ratio = painter->device()->devicePixelRatioF();
+    int pixelSize = static_cast<int>(std::ceil(halfSize * 2 * ratio));
+
+    QPixmap *newPx = new QPixmap(pixelSize, pixelSize);
+    newPx->setDevicePixelRatio(ratio);
+    newPx->fill(QColor(Qt::transparent));
+
+    {
+      QPainter pxPainter(newPx);
+      pxPainter.setRenderHints(painter->renderHints());
+      drawFunc(&pxPainter, halfSize);
+    }
+
+    pixmap = newPx;
+    symbolAtlas.insert(key, newPx, std::max(pixelSize * pixelSize * 4 / 1024, 1));
+  }
+
+  // Symbol center is at halfSize in the pixmap
+  painter->drawPixmap(QPointF(x - halfSize, y - halfSize), *pixmap);
+  return true;
+}
+
 void SymbolPainter::prepareForIcon(QPainter& painter)
 {
   painter.setRenderHint(QPainter::Antialiasing, true);
@@ -24,6 +24,9 @@
 #include <QIcon>
 #include <QApplication>
 #include <QCache>
+#include <QStaticText>
+
+#include <functional>
 
 namespace atools {
 namespace fs {
@@ -107,11 +110,15 @@ class SymbolPainter
 
 public:
   /*
-   * @param backgroundColor used for tooltips of table view icons
+   * @param useAtlas Blit airport, VOR, NDB and waypoint symbols from a lazily built pixmap atlas instead of
+   * drawing vectors for each call. Use for painters that draw many symbols repeatedly like map or table views.
    */
-  SymbolPainter();
+  SymbolPainter(bool useAtlas = false);
   ~SymbolPainter();
 
+  /* Drop all pre-rendered symbols of all instances. Call on style, color or symbol option changes. */
+  static void invalidateSymbolAtlas();
+
   /* Create icons for tooltips, table views and more. Size is pixel. */
   QIcon createAirportIcon(const map::MapAirport& airport, int size);
   QIcon createAirportWeatherIcon(const atools::fs::weather::Metar& metar, int size);
@@ -190,14 +197,50 @@ public:
   QRect textBoxSize(QPainter *painter, const QStringList& texts, textatt::TextAttributes atts);
 
 private:
+  /* Pre-laid-out text lines for a text box in drawing order. Cached per text list, font, resolution and attributes. */
+  struct TextBoxLayout
+  {
+    QVector<QStaticText> lines;
+    QVector<float> widths;
+    float lineHeight, ascent, descent;
+  };
+
+  /* Build key for text layout caches from texts, painter font and device resolution and attributes */
+  QString textLayoutKey(const QPainter *painter, const QStringList& texts, textatt::TextAttributes atts) const;
+
+  /* Apply font attributes like bold or italic to the painter font */
+  void setTextBoxFont(QPainter *painter, textatt::TextAttributes atts) const;
+
+  const TextBoxLayout *textBoxLayout(QPainter *painter, const QStringList& texts, textatt::TextAttributes atts);
+
   QStringList airportTexts(opts::DisplayOptions dispOpts, textflags::TextFlags flags,
                            const map::MapAirport& airport, int maxTextLength);
   const QPixmap *windPointerFromCache(int size);
   const QPixmap *trackLineFromCache(int size);
 
   QCache<int, QPixmap> windPointerPixmaps, trackLinePixmaps;
+
+  /* Laid out text box lines and text box sizes */
+  QCache<QString, TextBoxLayout> textLayouts;
+  QCache<QString, QRect> textBoxSizes;
   void prepareForIcon(QPainter& painter);
 
+  /* Draw pre-rendered symbol for key centered at x and y. Calls drawFunc with a painter for a new pixmap
+   * of size 2 * halfSize if key is not in the atlas. Returns false if symbol is too large for the atlas. */
+  bool drawFromAtlas(QPainter *painter, float x, float y, quint64 key, int halfSize,
+                     const std::function<void(QPainter *painter, int center)>& drawFunc);
+
+  /* Add bits to key which are common for all symbols like pixel ratio or antialiasing */
+  quint64 atlasBaseKey(QPainter *painter, quint64 kind, int size, bool fast) const;
+
+  /* Pre-rendered symbols keyed by kind, flags, size, fast and painter settings */
+  QCache<quint64, QPixmap> symbolAtlas;
+  bool atlasEnabled = false;
+
+  /* Compared against global generation to detect style changes */
+  int atlasGeneration = 0;
+  static int globalAtlasGeneration;
+
 };
 
 #endif // LITTLENAVMAP_SYMBOLPAINTER_H
@@ -115,6 +115,12 @@ public:
     fast = value;
   }
 
+  /* Change painter for a copy which is kept across paint events */
+  void setPainter(QPainter *value)
+  {
+    painter = value;
+  }
+
   /* Default is true which puts text always above the line. */
   void setTextOnTopOfLine(bool value)
   {
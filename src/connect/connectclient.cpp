@@ -198,6 +198,8 @@ void ConnectClient::disconnectedFromSimulatorDirect()
   metarIdentCache.clear();
   outstandingReplies.clear();
   queuedRequests.clear();
+  lastAiAircraft.clear();
+  aiAircraftIndexById.clear();
 
   if(!NavApp::isShuttingDown())
   {
@@ -208,6 +210,12 @@ void ConnectClient::disconnectedFromSimulatorDirect()
   manualDisconnect = false;
 }
 
+const atools::fs::sc::SimConnectAircraft *ConnectClient::getAiAircraftById(int objectId) const
+{
+  int index = getAiAircraftIndexById(objectId);
+  return index != -1 ? &lastAiAircraft.at(index) : nullptr;
+}
+
 /* Posts data received directly from simconnect or the socket and caches any metar reports */
 void ConnectClient::postSimConnectData(atools::fs::sc::SimConnectData dataPacket)
 {
@@ -223,6 +231,16 @@ void ConnectClient::postSimConnectData(atools::fs::sc::SimConnectData dataPacket
   if(NavApp::getOnlinedataController()->isShadowAircraft(userAircraft))
     userAircraft.setFlags(atools::fs::sc::SIM_ONLINE_SHADOW | userAircraft.getFlags());
 
+  if(dataPacket.getPacketId() > 0)
+  {
+    // Build object id index once for all receivers - ignore weather updates
+    lastAiAircraft = dataPacket.getAiAircraftConst();
+    aiAircraftIndexById.clear();
+    aiAircraftIndexById.reserve(lastAiAircraft.size());
+    for(int i = 0; i < lastAiAircraft.size(); i++)
+      aiAircraftIndexById.insert(lastAiAircraft.at(i).getObjectId(), i);
+  }
+
   emit dataPacketReceived(dataPacket);
 
   if(!dataPacket.getMetars().isEmpty())
@@ -531,6 +549,8 @@ void ConnectClient::closeSocket(bool allowRestart)
   metarIdentCache.clear();
   outstandingReplies.clear();
   queuedRequests.clear();
+  lastAiAircraft.clear();
+  aiAircraftIndexById.clear();
 
   if(socketConnected)
   {
@@ -76,6 +76,16 @@ public:
   bool isFetchAiShip() const;
   bool isFetchAiAircraft() const;
 
+  /* Index of the AI aircraft with the given object id in the AI list of the last received data packet.
+   * Built once per packet. Returns -1 if not found. */
+  int getAiAircraftIndexById(int objectId) const
+  {
+    return aiAircraftIndexById.value(objectId, -1);
+  }
+
+  /* AI aircraft with the given object id from the last received data packet or null if not found */
+  const atools::fs::sc::SimConnectAircraft *getAiAircraftById(int objectId) const;
+
 signals:
   /* Emitted when new data was received from the server (Little Navconnect), SimConnect or X-Plane.
    * can be aircraft position or weather update */
@@ -144,6 +154,10 @@ private:
   QSet<QString> outstandingReplies;
   QVector<atools::fs::sc::WeatherRequest> queuedRequests;
 
+  /* AI aircraft of the last packet and object id to index in this list */
+  QVector<atools::fs::sc::SimConnectAircraft> lastAiAircraft;
+  QHash<int, int> aiAircraftIndexById;
+
   // have to remember state separately to avoid sending signals when autoconnect fails
   bool socketConnected = false;
 };
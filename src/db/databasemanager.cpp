@@ -18,6 +18,7 @@
 #include "db/databasemanager.h"
 
 #include "db/databaseerrordialog.h"
+#include "db/databasepool.h"
 #include "gui/application.h"
 #include "options/optiondata.h"
 #include "common/constants.h"
@@ -54,6 +55,9 @@
 #include <QAbstractButton>
 #include <QSettings>
 #include <QSplashScreen>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <algorithm>
 
 using atools::gui::ErrorHandler;
 using atools::sql::SqlUtil;
@@ -175,6 +179,11 @@ DatabaseManager::DatabaseManager(MainWindow *parent)
     connect(databaseDialog, &DatabaseDialog::simulatorChanged, this, &DatabaseManager::simulatorChangedFromComboBox);
   }
 
+  // Notification from scenery loading thread
+  connect(&compileWatcher, &QFutureWatcher<bool>::finished, this, &DatabaseManager::loadSceneryFinished);
+  connect(this, &DatabaseManager::sceneryLoadProgress, this, &DatabaseManager::sceneryLoadProgressUpdate,
+          Qt::QueuedConnection);
+
   SqlDatabase::addDatabase(DATABASE_TYPE, DATABASE_NAME);
   SqlDatabase::addDatabase(DATABASE_TYPE, DATABASE_NAME_NAV);
   SqlDatabase::addDatabase(DATABASE_TYPE, DATABASE_NAME_DLG_INFO_TEMP);
@@ -183,6 +192,8 @@ DatabaseManager::DatabaseManager(MainWindow *parent)
   databaseSim = new SqlDatabase(DATABASE_NAME);
   databaseNav = new SqlDatabase(DATABASE_NAME_NAV);
 
+  databasePool = new DatabasePool;
+
   if(mainWindow != nullptr)
   {
     // Open only for instantiation in main window and not in main function
@@ -209,6 +220,18 @@ DatabaseManager::DatabaseManager(MainWindow *parent)
 
 DatabaseManager::~DatabaseManager()
 {
+  if(compiling)
+  {
+    // Stop scenery loading thread and wait for it
+    compileCancel = true;
+    compileWatcher.disconnect();
+    compileFuture.waitForFinished();
+    compiling = false;
+    removeCompilingDatabase();
+  }
+  delete compileOptions;
+  delete compileErrors;
+
   // Delete simulator switch actions
   freeActions();
 
@@ -221,6 +244,7 @@ DatabaseManager::~DatabaseManager()
   closeUserDatabase();
   closeOnlineDatabase();
 
+  delete databasePool;
   delete databaseSim;
   delete databaseNav;
   delete databaseUser;
@@ -620,6 +644,26 @@ void DatabaseManager::insertSimSwitchActions()
     connect(navDbActionBlend, &QAction::triggered, this, &DatabaseManager::switchNavFromMainMenu);
     connect(navDbActionOff, &QAction::triggered, this, &DatabaseManager::switchNavFromMainMenu);
   }
+
+  // Keep new actions disabled if a database is compiled in background
+  if(compiling)
+    enableDatabaseActions(false);
+}
+
+void DatabaseManager::enableDatabaseActions(bool enable)
+{
+  Ui::MainWindow *ui = NavApp::getMainUi();
+  ui->actionReloadScenery->setEnabled(enable);
+
+  // Noting to select if there is only one option
+  for(QAction *action : actions)
+    action->setEnabled(enable && actions.size() > 1);
+
+  if(navDbSubMenu != nullptr)
+    navDbSubMenu->setEnabled(enable);
+
+  // Airspace copy action depends on simulator and paths - let the main window update it
+  emit compilingChanged();
 }
 
 void DatabaseManager::insertSimSwitchAction(atools::fs::FsPaths::SimulatorType type, QAction *before, QMenu *menu,
@@ -658,6 +702,13 @@ void DatabaseManager::switchNavFromMainMenu()
 {
   qDebug() << Q_FUNC_INFO;
 
+  if(compiling)
+  {
+    // Actions are disabled while compiling - ignore triggers from shortcuts
+    qWarning() << Q_FUNC_INFO << "Scenery database is compiled";
+    return;
+  }
+
   if(navDbActionAll->isChecked())
   {
     QUrl url = atools::gui::HelpHandler::getHelpUrlWeb(lnm::HELP_ONLINE_NAVDATABASES, lnm::helpLanguageOnline());
@@ -716,7 +767,7 @@ void DatabaseManager::switchSimFromMainMenu()
 
   qDebug() << Q_FUNC_INFO << (action != nullptr ? action->text() : "null");
 
-  if(action != nullptr && currentFsType != action->data().value<atools::fs::FsPaths::SimulatorType>())
+  if(!compiling && action != nullptr && currentFsType != action->data().value<atools::fs::FsPaths::SimulatorType>())
   {
     QGuiApplication::setOverrideCursor(Qt::WaitCursor);
 
@@ -829,6 +880,67 @@ void DatabaseManager::openAllDatabases()
 
   openDatabaseFile(databaseSim, simDbFile, true /* readonly */, true /* createSchema */);
   openDatabaseFile(databaseNav, navDbFile, true /* readonly */, true /* createSchema */);
+
+  // Worker connections use a smaller page cache and normal locking to allow concurrent reads
+  Settings& settings = Settings::instance();
+  QStringList poolPragmas({QString("PRAGMA cache_size=-%1").
+                           arg(settings.getAndStoreValue(lnm::SETTINGS_DATABASE + "PoolCacheKb", 10000).toInt()),
+                           "PRAGMA locking_mode=NORMAL", "PRAGMA foreign_keys = OFF"});
+  databasePool->setDatabaseFiles(simDbFile, poolPragmas + buildReadonlyPragmas(simDbFile),
+                                 navDbFile, poolPragmas + buildReadonlyPragmas(navDbFile));
+
+  if(settings.getAndStoreValue(lnm::SETTINGS_DATABASE + "PreWarm", true).toBool())
+  {
+    preWarmDatabase(databaseSim);
+
+    if(navDbFile != simDbFile)
+      preWarmDatabase(databaseNav);
+  }
+}
+
+void DatabaseManager::preWarmDatabase(atools::sql::SqlDatabase *db)
+{
+  // Tables and coordinate indexes used by the map bounding rectangle queries
+  static const QVector<std::pair<QString, QString> > HOT_INDEXES(
+  {
+    {"airport", "lonx"}, {"airport", "laty"},
+    {"airport_medium", "lonx"}, {"airport_large", "lonx"},
+    {"vor", "lonx"}, {"vor", "laty"},
+    {"ndb", "lonx"}, {"ndb", "laty"},
+    {"waypoint", "lonx"}, {"waypoint", "laty"},
+    {"ils", "lonx"},
+    {"airway", "left_lonx"}, {"airway", "right_lonx"},
+    {"boundary", "max_lonx"}, {"boundary", "min_lonx"}
+  });
+
+  try
+  {
+    QElapsedTimer timer;
+    timer.start();
+
+    SqlUtil util(db);
+    int numEntries = 0;
+    for(const std::pair<QString, QString>& index : HOT_INDEXES)
+    {
+      if(util.hasTable(index.first))
+      {
+        // Counting over the indexed column reads all index pages but not the table rows
+        SqlQuery query(db);
+        query.exec(QString("select count(%2) from %1 where %2 >= -180. and %2 <= 180.").
+                   arg(index.first).arg(index.second));
+        if(query.next())
+          numEntries += query.value(0).toInt();
+      }
+    }
+
+    qInfo() << Q_FUNC_INFO << "Pre-warming" << db->databaseName() << "touched" << numEntries << "index entries in"
+            << timer.elapsed() << "ms";
+  }
+  catch(atools::Exception& e)
+  {
+    // Not critical - database is usable without pre-warming
+    qWarning() << Q_FUNC_INFO << "Pre-warming failed" << e.what();
+  }
 }
 
 void DatabaseManager::openDatabaseFile(atools::sql::SqlDatabase *db, const QString& file, bool readonly,
@@ -851,44 +963,20 @@ void DatabaseManager::openDatabaseFile(atools::sql::SqlDatabase *db, const QStri
 void DatabaseManager::openDatabaseFileInternal(atools::sql::SqlDatabase *db, const QString& file, bool readonly,
                                                bool createSchema, bool exclusive, bool autoTransactions)
 {
-  atools::settings::Settings& settings = atools::settings::Settings::instance();
-  int databaseCacheKb = settings.getAndStoreValue(lnm::SETTINGS_DATABASE + "CacheKb", 50000).toInt();
-  bool foreignKeys = settings.getAndStoreValue(lnm::SETTINGS_DATABASE + "ForeignKeys", false).toBool();
+  QStringList databasePragmas = buildDatabasePragmas(readonly, exclusive);
 
-  // cache_size * 1024 bytes if value is negative
-  QStringList databasePragmas({QString("PRAGMA cache_size=-%1").arg(databaseCacheKb), "PRAGMA page_size=8196"});
-
-  if(exclusive)
-  {
-    // Best settings for loading databases accessed write only - unsafe
-    databasePragmas.append("PRAGMA locking_mode=EXCLUSIVE");
-    databasePragmas.append("PRAGMA journal_mode=TRUNCATE");
-    databasePragmas.append("PRAGMA synchronous=OFF");
-  }
-  else
-  {
-    // Best settings for online and user databases which are updated often - read/write
-    databasePragmas.append("PRAGMA locking_mode=NORMAL");
-    databasePragmas.append("PRAGMA journal_mode=DELETE");
-    databasePragmas.append("PRAGMA synchronous=NORMAL");
-  }
-
-  if(!readonly)
-    databasePragmas.append("PRAGMA busy_timeout=2000");
+  // Tuned profile for the large read-only navdata databases which are never changed while open
+  QStringList databasePragmasReadonly(databasePragmas);
+  if(readonly)
+    databasePragmasReadonly.append(buildReadonlyPragmas(file));
 
   qDebug() << "Opening database" << file;
   db->setDatabaseName(file);
 
-  // Set foreign keys only on demand because they can decrease loading performance
-  if(foreignKeys)
-    databasePragmas.append("PRAGMA foreign_keys = ON");
-  else
-    databasePragmas.append("PRAGMA foreign_keys = OFF");
-
   bool autocommit = db->isAutocommit();
   db->setAutocommit(false);
   db->setAutomaticTransactions(autoTransactions);
-  db->open(databasePragmas);
+  db->open(readonly && db->isReadonly() ? databasePragmasReadonly : databasePragmas);
 
   db->setAutocommit(autocommit);
 
@@ -913,7 +1001,7 @@ void DatabaseManager::openDatabaseFileInternal(atools::sql::SqlDatabase *db, con
     // Readonly requested - reopen database
     db->close();
     db->setReadonly();
-    db->open(databasePragmas);
+    db->open(databasePragmasReadonly);
   }
 
   DatabaseMeta dbmeta(db);
@@ -924,8 +1012,61 @@ void DatabaseManager::openDatabaseFileInternal(atools::sql::SqlDatabase *db, con
                     << DatabaseMeta::DB_VERSION_MAJOR << "." << DatabaseMeta::DB_VERSION_MINOR;
 }
 
+QStringList DatabaseManager::buildDatabasePragmas(bool readonly, bool exclusive)
+{
+  atools::settings::Settings& settings = atools::settings::Settings::instance();
+  int databaseCacheKb = settings.getAndStoreValue(lnm::SETTINGS_DATABASE + "CacheKb", 50000).toInt();
+  bool foreignKeys = settings.getAndStoreValue(lnm::SETTINGS_DATABASE + "ForeignKeys", false).toBool();
+
+  // cache_size * 1024 bytes if value is negative
+  QStringList databasePragmas({QString("PRAGMA cache_size=-%1").arg(databaseCacheKb), "PRAGMA page_size=8196"});
+
+  if(exclusive)
+  {
+    // Best settings for loading databases accessed write only - unsafe
+    databasePragmas.append("PRAGMA locking_mode=EXCLUSIVE");
+    databasePragmas.append("PRAGMA journal_mode=TRUNCATE");
+    databasePragmas.append("PRAGMA synchronous=OFF");
+  }
+  else
+  {
+    // Best settings for online and user databases which are updated often - read/write
+    databasePragmas.append("PRAGMA locking_mode=NORMAL");
+    databasePragmas.append("PRAGMA journal_mode=DELETE");
+    databasePragmas.append("PRAGMA synchronous=NORMAL");
+  }
+
+  if(!readonly)
+    databasePragmas.append("PRAGMA busy_timeout=2000");
+
+  // Set foreign keys only on demand because they can decrease loading performance
+  if(foreignKeys)
+    databasePragmas.append("PRAGMA foreign_keys = ON");
+  else
+    databasePragmas.append("PRAGMA foreign_keys = OFF");
+
+  return databasePragmas;
+}
+
+QStringList DatabaseManager::buildReadonlyPragmas(const QString& file)
+{
+  QStringList pragmas;
+
+  // Map the whole file into memory up to the configured limit to avoid the copying read calls
+  qint64 mmapMaxMb = Settings::instance().getAndStoreValue(lnm::SETTINGS_DATABASE + "MmapMaxMb", 2048).toLongLong();
+  qint64 mmapSize = std::min(QFileInfo(file).size(), mmapMaxMb * 1024L * 1024L);
+  if(mmapSize > 0)
+    pragmas.append(QString("PRAGMA mmap_size=%1").arg(mmapSize));
+
+  pragmas.append("PRAGMA temp_store=MEMORY");
+  pragmas.append("PRAGMA query_only=ON");
+  return pragmas;
+}
+
 void DatabaseManager::closeDatabases()
 {
+  databasePool->closeAll();
+
   closeDatabaseFile(databaseSim);
   closeDatabaseFile(databaseNav);
 }
@@ -964,6 +1105,15 @@ void DatabaseManager::run()
 {
   qDebug() << Q_FUNC_INFO;
 
+  if(compiling)
+  {
+    // Loading is already running in background - bring progress to front
+    progressDialog->show();
+    progressDialog->raise();
+    progressDialog->activateWindow();
+    return;
+  }
+
   if(simulators.value(currentFsType).isInstalled)
     // Use what is currently displayed on the map
     selectedFsType = currentFsType;
@@ -974,7 +1124,7 @@ void DatabaseManager::run()
 
   updateDialogInfo(selectedFsType);
 
-  // try until user hits cancel or the database was loaded successfully
+  // try until user hits cancel or the database loading was started
   while(runInternal())
     ;
 
@@ -988,6 +1138,13 @@ void DatabaseManager::copyAirspaces()
 {
   qDebug() << Q_FUNC_INFO;
 
+  if(compiling)
+  {
+    // Target database might be compiled
+    qWarning() << Q_FUNC_INFO << "Scenery database is compiled";
+    return;
+  }
+
   try
   {
     // The current database is read only so we cannot use the attach command
@@ -1066,7 +1223,7 @@ void DatabaseManager::copyAirspaces()
 }
 
 /* Shows scenery database loading dialog.
- * @return true if execution was successfull. false if it was cancelled */
+ * @return true if the dialog has to be shown again. false if it was cancelled or loading was started */
 bool DatabaseManager::runInternal()
 {
   qDebug() << Q_FUNC_INFO;
@@ -1096,72 +1253,14 @@ bool DatabaseManager::runInternal()
         if(selectedFsType == atools::fs::FsPaths::XPLANE11 ||
            atools::fs::NavDatabase::isSceneryConfigValid(databaseDialog->getSceneryConfigFile(), sceneryCfgCodec, err))
         {
-          // Compile into a temporary database file
-          QString selectedFilename = buildDatabaseFileName(selectedFsType);
-          QString tempFilename = buildCompilingDatabaseFileName();
-
-          if(QFile::remove(tempFilename))
-            qInfo() << "Removed" << tempFilename;
-          else
-            qWarning() << "Removing" << tempFilename << "failed";
-
-          QFile journal(tempFilename + "-journal");
-          if(journal.exists() && journal.size() == 0)
-          {
-            if(journal.remove())
-              qInfo() << "Removed" << journal.fileName();
-            else
-              qWarning() << "Removing" << journal.fileName() << "failed";
-          }
-
-          SqlDatabase tempDb(DATABASE_NAME_TEMP);
-          openDatabaseFile(&tempDb, tempFilename, false /* readonly */, true /* createSchema */);
-
-          if(loadScenery(&tempDb))
-          {
-            // Successfully loaded
-            reopenDialog = false;
-
-            closeDatabaseFile(&tempDb);
-
-            emit preDatabaseLoad();
-            closeDatabases();
+          // Compile into a temporary database file in background - current database stays usable
+          compileTargetFilename = buildDatabaseFileName(selectedFsType);
+          compileTempFilename = buildCompilingDatabaseFileName();
 
-            // Remove old database
-            if(QFile::remove(selectedFilename))
-              qInfo() << "Removed" << selectedFilename;
-            else
-              qWarning() << "Removing" << selectedFilename << "failed";
+          removeCompilingDatabase();
 
-            // Rename temporary file to new database
-            if(QFile::rename(tempFilename, selectedFilename))
-              qInfo() << "Renamed" << tempFilename << "to" << selectedFilename;
-            else
-              qWarning() << "Renaming" << tempFilename << "to" << selectedFilename << "failed";
-
-            // Syncronize display with loaded database
-            currentFsType = selectedFsType;
-
-            openAllDatabases();
-            emit postDatabaseLoad(currentFsType);
-          }
-          else
-          {
-            closeDatabaseFile(&tempDb);
-            if(QFile::remove(tempFilename))
-              qInfo() << "Removed" << tempFilename;
-            else
-              qWarning() << "Removing" << tempFilename << "failed";
-
-            QFile journal2(tempFilename + "-journal");
-            if(journal2.exists() && journal2.size() == 0)
-            {
-              if(journal2.remove())
-                qInfo() << "Removed" << journal2.fileName();
-              else
-                qWarning() << "Removing" << journal2.fileName() << "failed";
-            }
-          }
+          loadScenery();
+          reopenDialog = false;
         }
         else
           atools::gui::Dialog::warning(databaseDialog, tr("Cannot read \"%1\". Reason: %2.").
@@ -1186,39 +1285,60 @@ bool DatabaseManager::runInternal()
   return reopenDialog;
 }
 
-/* Opens progress dialog and loads scenery
- * @return true if loading was successfull. false if cancelled or an error occured */
-bool DatabaseManager::loadScenery(atools::sql::SqlDatabase *db)
+/* Removes the temporary compilation database and an empty journal if present */
+void DatabaseManager::removeCompilingDatabase()
+{
+  if(QFile::remove(compileTempFilename))
+    qInfo() << "Removed" << compileTempFilename;
+  else
+    qWarning() << "Removing" << compileTempFilename << "failed";
+
+  QFile journal(compileTempFilename + "-journal");
+  if(journal.exists() && journal.size() == 0)
+  {
+    if(journal.remove())
+      qInfo() << "Removed" << journal.fileName();
+    else
+      qWarning() << "Removing" << journal.fileName() << "failed";
+  }
+}
+
+/* Opens a non-modal progress dialog and starts loading of the scenery in a background thread */
+void DatabaseManager::loadScenery()
 {
   using atools::fs::NavDatabaseOptions;
 
-  bool success = true;
   // Get configuration file path from resources or overloaded path
   QString config = Settings::getOverloadedPath(lnm::DATABASE_NAVDATAREADER_CONFIG);
   qInfo() << "loadScenery: Config file" << config;
 
   QSettings settings(config, QSettings::IniFormat);
 
-  NavDatabaseOptions navDatabaseOpts;
-  navDatabaseOpts.loadFromSettings(settings);
+  delete compileOptions;
+  compileOptions = new NavDatabaseOptions;
+  compileOptions->loadFromSettings(settings);
 
-  navDatabaseOpts.setReadInactive(readInactive);
-  navDatabaseOpts.setReadAddOnXml(readAddOnXml);
+  compileOptions->setReadInactive(readInactive);
+  compileOptions->setReadAddOnXml(readAddOnXml);
 
   // Add exclude paths from option dialog
   const OptionData& optionData = OptionData::instance();
-  navDatabaseOpts.addToAddonDirectoryExcludes(optionData.getDatabaseAddonExclude());
-  navDatabaseOpts.addToDirectoryExcludes(optionData.getDatabaseExclude());
-  navDatabaseOpts.setSimulatorType(selectedFsType);
+  compileOptions->addToAddonDirectoryExcludes(optionData.getDatabaseAddonExclude());
+  compileOptions->addToDirectoryExcludes(optionData.getDatabaseExclude());
+  // Remember simulator - loadSceneryFinished must not depend on later changes of the selection
+  compileFsType = selectedFsType;
+  compileOptions->setSimulatorType(compileFsType);
 
   delete progressDialog;
   progressDialog = new QProgressDialog(mainWindow);
   progressDialog->setWindowFlags(progressDialog->windowFlags() & ~Qt::WindowContextHelpButtonHint);
-  progressDialog->setWindowModality(Qt::ApplicationModal);
+
+  // Application stays usable while loading
+  progressDialog->setWindowModality(Qt::NonModal);
 
   progressDialog->setWindowTitle(tr("%1 - Loading %2").
                                  arg(QApplication::applicationName()).
-                                 arg(atools::fs::FsPaths::typeToShortName(selectedFsType)));
+                                 arg(atools::fs::FsPaths::typeToShortName(compileFsType)));
 
   // Label will be owned by progress
   QLabel *label = new QLabel(progressDialog);
@@ -1231,11 +1351,11 @@ bool DatabaseManager::loadScenery(atools::sql::SqlDatabase *db)
   progressDialog->setAutoClose(false);
   progressDialog->setAutoReset(false);
   progressDialog->setMinimumDuration(0);
+  connect(progressDialog, &QProgressDialog::canceled, this, &DatabaseManager::loadSceneryCanceled);
 
-  navDatabaseOpts.setSceneryFile(simulators.value(selectedFsType).sceneryCfg);
-  navDatabaseOpts.setBasepath(simulators.value(selectedFsType).basePath);
+  compileOptions->setSceneryFile(simulators.value(compileFsType).sceneryCfg);
+  compileOptions->setBasepath(simulators.value(compileFsType).basePath);
 
-  QElapsedTimer timer;
   progressTimerElapsed = 0L;
 
   progressDialog->setLabelText(
@@ -1245,39 +1365,166 @@ bool DatabaseManager::loadScenery(atools::sql::SqlDatabase *db)
 
   progressDialog->show();
 
-  navDatabaseOpts.setProgressCallback(std::bind(&DatabaseManager::progressCallback, this,
-                                                std::placeholders::_1, timer));
+  // Called in the loading thread
+  compileOptions->setProgressCallback(std::bind(&DatabaseManager::progressCallback, this,
+                                                std::placeholders::_1, std::ref(compileTimer)));
 
-  // Let the dialog close and show the busy pointer
-  QApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
-  atools::fs::NavDatabaseErrors errors;
+  qInfo() << Q_FUNC_INFO << *compileOptions;
 
-  qInfo() << Q_FUNC_INFO << navDatabaseOpts;
+  delete compileErrors;
+  compileErrors = new atools::fs::NavDatabaseErrors;
+  compileException = nullptr;
+  currentBglFilePath.clear();
+  compileCancel = false;
+  compiling = true;
 
-  try
+  // Switching or reloading databases is not allowed until the compilation is finished
+  enableDatabaseActions(false);
+
+  // Prepare settings here since they cannot be accessed from the thread
+  QStringList pragmas = buildDatabasePragmas(false /* readonly */, true /* exclusive */);
+  QString sceneryCfgCodec = compileFsType == atools::fs::FsPaths::P3D_V4 ? "UTF-8" : QString();
+
+  // Watcher will call loadSceneryFinished when done
+  compileFuture = QtConcurrent::run(this, &DatabaseManager::loadSceneryThread, pragmas, sceneryCfgCodec);
+  compileWatcher.setFuture(compileFuture);
+}
+
+/* Background thread. Compiles the scenery into the temporary database using its own connection.
+ * @return true if loading was successfull. false if cancelled or an exception occured */
+bool DatabaseManager::loadSceneryThread(QStringList pragmas, QString sceneryCfgCodec)
+{
+  bool success = true;
+
+  // Connection has to be created in this thread
+  SqlDatabase::addDatabase(DATABASE_TYPE, DATABASE_NAME_COMPILE);
   {
-    atools::fs::NavDatabase nd(&navDatabaseOpts, db, &errors, GIT_REVISION);
-    QString sceneryCfgCodec = selectedFsType == atools::fs::FsPaths::P3D_V4 ? "UTF-8" : QString();
-    nd.create(sceneryCfgCodec);
+    SqlDatabase db(DATABASE_NAME_COMPILE);
+    try
+    {
+      db.setDatabaseName(compileTempFilename);
+      db.setAutocommit(false);
+      db.setAutomaticTransactions(true);
+      db.open(pragmas);
+
+      if(!DatabaseMeta(&db).hasSchema())
+      {
+        NavDatabaseOptions opts;
+        NavDatabase(&opts, &db, nullptr, GIT_REVISION).createSchema();
+        DatabaseMeta(&db).updateVersion();
+      }
+
+      NavDatabase nd(compileOptions, &db, compileErrors, GIT_REVISION);
+      nd.create(sceneryCfgCodec);
+    }
+    catch(...)
+    {
+      // Pass exception to the GUI thread to show the error dialog
+      compileException = std::current_exception();
+      success = false;
+    }
+
+    if(db.isOpen())
+      db.close();
   }
-  catch(atools::Exception& e)
+  SqlDatabase::removeDatabase(DATABASE_NAME_COMPILE);
+
+  return success && !compileCancel;
+}
+
+/* Called by watcher when the loading thread is finished. Swaps databases if loading was successfull. */
+void DatabaseManager::loadSceneryFinished()
+{
+  bool success = compileFuture.result();
+  compiling = false;
+  enableDatabaseActions(true);
+
+  qInfo() << Q_FUNC_INFO << "success" << success << "cancelled" << compileCancel;
+
+  if(compileException)
   {
     // Show dialog if something went wrong but do not exit
-    ErrorHandler(progressDialog).handleException(
-      e, currentBglFilePath.isEmpty() ? QString() : tr("Processed files:\n%1\n").arg(currentBglFilePath));
-    success = false;
+    QString files = currentBglFilePath.isEmpty() ? QString() : tr("Processed files:\n%1\n").arg(currentBglFilePath);
+    try
+    {
+      std::rethrow_exception(compileException);
+    }
+    catch(atools::Exception& e)
+    {
+      ErrorHandler(progressDialog).handleException(e, files);
+    }
+    catch(...)
+    {
+      ErrorHandler(progressDialog).handleUnknownException(files);
+    }
+    compileException = nullptr;
   }
-  catch(...)
+
+  // Show errors that occured during loading, if any
+  showLoadingErrors();
+
+  if(success)
   {
-    // Show dialog if something went wrong but do not exit
-    ErrorHandler(progressDialog).handleUnknownException(
-      currentBglFilePath.isEmpty() ? QString() : tr("Processed files:\n%1\n").arg(currentBglFilePath));
-    success = false;
+    emit preDatabaseLoad();
+    closeDatabases();
+
+    // Remove old database
+    if(QFile::remove(compileTargetFilename))
+      qInfo() << "Removed" << compileTargetFilename;
+    else
+      qWarning() << "Removing" << compileTargetFilename << "failed";
+
+    // Rename temporary file to new database
+    if(QFile::rename(compileTempFilename, compileTargetFilename))
+      qInfo() << "Renamed" << compileTempFilename << "to" << compileTargetFilename;
+    else
+      qWarning() << "Renaming" << compileTempFilename << "to" << compileTargetFilename << "failed";
+
+    // Syncronize display with loaded database
+    currentFsType = compileFsType;
+
+    openAllDatabases();
+    emit postDatabaseLoad(currentFsType);
+
+    updateSimulatorFlags();
+    insertSimSwitchActions();
+    saveState();
+
+    // Keep results shown until user clicks ok
+    progressDialog->setCancelButtonText(tr("&OK"));
+    progressDialog->show();
   }
+  else
+  {
+    removeCompilingDatabase();
 
-  QApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+    progressDialog->deleteLater();
+    progressDialog = nullptr;
+
+    // Loading was cancelled or failed - show dialog again
+    run();
+  }
+}
+
+/* Cancel button in progress dialog clicked */
+void DatabaseManager::loadSceneryCanceled()
+{
+  if(compiling)
+    // Stop loading - thread will notice this in the next progress callback
+    compileCancel = true;
+  else if(progressDialog != nullptr)
+  {
+    // OK button after successfull loading
+    progressDialog->deleteLater();
+    progressDialog = nullptr;
+  }
+}
+
+/* Shows a dialog with all errors that occured while loading the scenery, if any */
+void DatabaseManager::showLoadingErrors()
+{
+  atools::fs::NavDatabaseErrors& errors = *compileErrors;
 
-  // Show errors that occured during loading, if any
   if(errors.getTotalErrors() > 0)
   {
     QString errorTexts;
@@ -1331,22 +1578,6 @@ bool DatabaseManager::loadScenery(atools::sql::SqlDatabase *db)
     errorDialog.setErrorMessages(errorTexts);
     errorDialog.exec();
   }
-
-  QApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
-  if(!progressDialog->wasCanceled() && success)
-  {
-    // Show results and wait until user selects ok
-    progressDialog->setCancelButtonText(tr("&OK"));
-    progressDialog->exec();
-  }
-  else
-    // Loading was cancelled
-    success = false;
-
-  delete progressDialog;
-  progressDialog = nullptr;
-
-  return success;
 }
 
 /* Simulator was changed in scenery database loading dialog */
@@ -1356,91 +1587,103 @@ void DatabaseManager::simulatorChangedFromComboBox(FsPaths::SimulatorType value)
   updateDialogInfo(selectedFsType);
 }
 
-/* Called by atools::fs::NavDatabase. Updates progress bar and statistics */
+/* Called by atools::fs::NavDatabase in the loading thread. Sends progress and statistics to the dialog. */
 bool DatabaseManager::progressCallback(const atools::fs::NavDatabaseProgress& progress, QElapsedTimer& timer)
 {
-  if(progressDialog->wasCanceled())
+  if(compileCancel)
     return true;
 
   if(progress.isFirstCall())
-  {
     timer.start();
-    progressDialog->setMinimum(0);
-    progressDialog->setMaximum(progress.getTotal());
-  }
 
   // Update only four times a second
   if((timer.elapsed() - progressTimerElapsed) > 250 || progress.isLastCall())
   {
-    progressDialog->setValue(progress.getCurrent());
+    int current = progress.getCurrent();
+    QString text;
 
     if(progress.isNewOther())
     {
       currentBglFilePath.clear();
 
       // Run script etc.
-      progressDialog->setLabelText(
-        databaseTimeText.arg(progress.getOtherAction()).
-        arg(formatter::formatElapsed(timer)).
-        arg(QString()).
-        arg(QString()).
-        arg(progress.getNumErrors()).
-        arg(progress.getNumFiles()).
-        arg(progress.getNumAirports()).
-        arg(progress.getNumVors()).
-        arg(progress.getNumIls()).
-        arg(progress.getNumNdbs()).
-        arg(progress.getNumMarker()).
-        arg(progress.getNumWaypoints()).
-        arg(progress.getNumBoundaries()));
+      text = databaseTimeText.arg(progress.getOtherAction()).
+             arg(formatter::formatElapsed(timer)).
+             arg(QString()).
+             arg(QString()).
+             arg(progress.getNumErrors()).
+             arg(progress.getNumFiles()).
+             arg(progress.getNumAirports()).
+             arg(progress.getNumVors()).
+             arg(progress.getNumIls()).
+             arg(progress.getNumNdbs()).
+             arg(progress.getNumMarker()).
+             arg(progress.getNumWaypoints()).
+             arg(progress.getNumBoundaries());
     }
     else if(progress.isNewSceneryArea() || progress.isNewFile())
     {
       currentBglFilePath = progress.getBglFilePath();
 
       // Switched to a new scenery area
-      progressDialog->setLabelText(
-        databaseLoadingText.arg(progress.getSceneryTitle()).
-        arg(progress.getSceneryPath()).
-        arg(progress.getBglFileName()).
-        arg(formatter::formatElapsed(timer)).
-        arg(progress.getNumErrors()).
-        arg(progress.getNumFiles()).
-        arg(progress.getNumAirports()).
-        arg(progress.getNumVors()).
-        arg(progress.getNumIls()).
-        arg(progress.getNumNdbs()).
-        arg(progress.getNumMarker()).
-        arg(progress.getNumWaypoints()).
-        arg(progress.getNumBoundaries()));
+      text = databaseLoadingText.arg(progress.getSceneryTitle()).
+             arg(progress.getSceneryPath()).
+             arg(progress.getBglFileName()).
+             arg(formatter::formatElapsed(timer)).
+             arg(progress.getNumErrors()).
+             arg(progress.getNumFiles()).
+             arg(progress.getNumAirports()).
+             arg(progress.getNumVors()).
+             arg(progress.getNumIls()).
+             arg(progress.getNumNdbs()).
+             arg(progress.getNumMarker()).
+             arg(progress.getNumWaypoints()).
+             arg(progress.getNumBoundaries());
     }
     else if(progress.isLastCall())
     {
       currentBglFilePath.clear();
-      progressDialog->setValue(progress.getTotal());
+      current = progress.getTotal();
 
       // Last report
-      progressDialog->setLabelText(
-        databaseTimeText.arg(tr("<big>Done.</big>")).
-        arg(formatter::formatElapsed(timer)).
-        arg(QString()).
-        arg(QString()).
-        arg(progress.getNumErrors()).
-        arg(progress.getNumFiles()).
-        arg(progress.getNumAirports()).
-        arg(progress.getNumVors()).
-        arg(progress.getNumIls()).
-        arg(progress.getNumNdbs()).
-        arg(progress.getNumMarker()).
-        arg(progress.getNumWaypoints()).
-        arg(progress.getNumBoundaries()));
+      text = databaseTimeText.arg(tr("<big>Done.</big>")).
+             arg(formatter::formatElapsed(timer)).
+             arg(QString()).
+             arg(QString()).
+             arg(progress.getNumErrors()).
+             arg(progress.getNumFiles()).
+             arg(progress.getNumAirports()).
+             arg(progress.getNumVors()).
+             arg(progress.getNumIls()).
+             arg(progress.getNumNdbs()).
+             arg(progress.getNumMarker()).
+             arg(progress.getNumWaypoints()).
+             arg(progress.getNumBoundaries());
     }
 
-    QApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+    // Queued to the GUI thread
+    emit sceneryLoadProgress(current, progress.getTotal(), text);
     progressTimerElapsed = timer.elapsed();
   }
 
-  return progressDialog->wasCanceled();
+  return compileCancel;
+}
+
+/* Progress from loading thread arriving in the GUI thread */
+void DatabaseManager::sceneryLoadProgressUpdate(int value, int maximum, const QString& text)
+{
+  if(progressDialog == nullptr || !compiling)
+    return;
+
+  if(progressDialog->maximum() != maximum)
+  {
+    progressDialog->setMinimum(0);
+    progressDialog->setMaximum(maximum);
+  }
+  progressDialog->setValue(value);
+
+  if(!text.isEmpty())
+    progressDialog->setLabelText(text);
 }
 
 /* Checks if the current database has a schema. Exits program if this fails */
@@ -23,11 +23,19 @@
 #include "db/dbtypes.h"
 
 #include <QAction>
+#include <QElapsedTimer>
+#include <QFuture>
+#include <QFutureWatcher>
 #include <QObject>
 
+#include <atomic>
+#include <exception>
+
 namespace atools {
 namespace fs {
 class NavDatabaseProgress;
+class NavDatabaseOptions;
+struct NavDatabaseErrors;
 
 namespace userdata {
 class UserdataManager;
@@ -41,8 +49,8 @@ class OnlinedataManager;
 }
 
 class QProgressDialog;
-class QElapsedTimer;
 class DatabaseDialog;
+class DatabasePool;
 class MainWindow;
 class QSplashScreen;
 class QMessageBox;
@@ -75,9 +83,16 @@ public:
   /* Also closes database if not already done */
   virtual ~DatabaseManager();
 
-  /* Opens the dialog that allows to (re)load a new scenery database. */
+  /* Opens the dialog that allows to (re)load a new scenery database.
+   * Loading is done in background and the current database stays usable until loading is finished. */
   void run();
 
+  /* true while a scenery database is loaded in background */
+  bool isCompiling() const
+  {
+    return compiling;
+  }
+
   /* Copy the boundary table from the currently selected FSX/P3D database to the X-Plane database */
   void copyAirspaces();
 
@@ -155,6 +170,9 @@ public:
     return onlinedataManager;
   }
 
+  /* Pragmas for all databases depending on access mode. Used for connections opened in other threads too. */
+  QStringList buildDatabasePragmas(bool readonly, bool exclusive);
+
   atools::sql::SqlDatabase *getDatabaseUser() const
   {
     return databaseUser;
@@ -162,6 +180,12 @@ public:
 
   atools::sql::SqlDatabase *getDatabaseOnline() const;
 
+  /* Read-only connections to the simulator and navdata databases for worker threads */
+  DatabasePool *getDatabasePool() const
+  {
+    return databasePool;
+  }
+
 signals:
   /* Emitted before opening the scenery database dialog, loading a database or switching to a new simulator database.
    * Recipients have to close all database connections and clear all caches. The database instance itself is not changed
@@ -173,6 +197,12 @@ signals:
    */
   void postDatabaseLoad(atools::fs::FsPaths::SimulatorType type);
 
+  /* Sent from the scenery loading thread and queued to the GUI thread. Text is empty if unchanged. */
+  void sceneryLoadProgress(int value, int maximum, const QString& text);
+
+  /* Emitted when background loading starts or ends. Used to update actions depending on other states. */
+  void compilingChanged();
+
 private:
   /* Catches exceptions and terminates program if any */
   void openDatabaseFile(atools::sql::SqlDatabase *db, const QString& file, bool readonly, bool createSchema);
@@ -183,6 +213,13 @@ private:
 
   void closeDatabaseFile(atools::sql::SqlDatabase *db);
 
+  /* Pragmas for the read-only navdata database profile. Adds memory mapping sized to the file. */
+  QStringList buildReadonlyPragmas(const QString& file);
+
+  /* Reads the coordinate index pages of the map tables to fill the memory map and the page cache.
+   * Logs the elapsed time. Does not throw exceptions. */
+  void preWarmDatabase(atools::sql::SqlDatabase *db);
+
   void restoreState();
 
   void createEmptySchema(atools::sql::SqlDatabase *db);
@@ -190,8 +227,12 @@ private:
   bool hasSchema(atools::sql::SqlDatabase *db);
   bool hasData(atools::sql::SqlDatabase *db);
 
+  /* Called from the loading thread */
   bool progressCallback(const atools::fs::NavDatabaseProgress& progress, QElapsedTimer& timer);
 
+  /* Updates the progress dialog in the GUI thread */
+  void sceneryLoadProgressUpdate(int value, int maximum, const QString& text);
+
   void simulatorChangedFromComboBox(atools::fs::FsPaths::SimulatorType value);
   bool runInternal();
   void updateDialogInfo(atools::fs::FsPaths::SimulatorType value);
@@ -212,10 +253,20 @@ private:
   void switchNavFromMainMenu();
 
   void freeActions();
+
+  /* Enable or disable all main menu actions that switch or reload databases. Disabled while compiling.
+   * The airspace copy action is updated by the main window. */
+  void enableDatabaseActions(bool enable);
   void insertSimSwitchAction(atools::fs::FsPaths::SimulatorType type, QAction *before, QMenu *menu, int index);
   void updateSimulatorFlags();
   void updateSimulatorPathsFromDialog();
-  bool loadScenery(atools::sql::SqlDatabase *db);
+  /* Starts loading into the temporary database in a background thread */
+  void loadScenery();
+  bool loadSceneryThread(QStringList pragmas, QString sceneryCfgCodec);
+  void loadSceneryFinished();
+  void loadSceneryCanceled();
+  void showLoadingErrors();
+  void removeCompilingDatabase();
   void correctSimulatorType();
   QMessageBox *showSimpleProgressDialog(const QString& message);
   void deleteSimpleProgressDialog(QMessageBox *messageBox);
@@ -237,6 +288,7 @@ private:
   const QString DATABASE_NAME_ONLINE = "LNMDBONLINE";
 
   const QString DATABASE_NAME_TEMP = "LNMTEMPDB";
+  const QString DATABASE_NAME_COMPILE = "LNMCOMPILEDB";
   const QString DATABASE_NAME_DLG_INFO_TEMP = "LNMTEMPDB2";
   const QString DATABASE_TYPE = "QSQLITE";
 
@@ -282,6 +334,24 @@ private:
   atools::fs::userdata::UserdataManager *userdataManager = nullptr;
   atools::fs::online::OnlinedataManager *onlinedataManager = nullptr;
 
+  /* Per thread connections for background queries */
+  DatabasePool *databasePool = nullptr;
+
+  /* Background scenery loading - options, errors, file names and timer are only accessed by the thread while
+   * compiling is true */
+  QFuture<bool> compileFuture;
+  QFutureWatcher<bool> compileWatcher;
+  atools::fs::NavDatabaseOptions *compileOptions = nullptr;
+  atools::fs::NavDatabaseErrors *compileErrors = nullptr;
+  std::exception_ptr compileException;
+  QString compileTempFilename, compileTargetFilename;
+
+  /* Simulator that is currently compiled - selectedFsType is not used since it belongs to the dialog */
+  atools::fs::FsPaths::SimulatorType compileFsType = atools::fs::FsPaths::UNKNOWN;
+  QElapsedTimer compileTimer;
+  std::atomic_bool compileCancel {false};
+  bool compiling = false;
+
 };
 
 #endif // LITTLENAVMAP_DATABASEMANAGER_H
@@ -0,0 +1,158 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "db/databasepool.h"
+
+#include "sql/sqldatabase.h"
+
+#include <QDebug>
+#include <QThread>
+
+using atools::sql::SqlDatabase;
+
+/* Qt SQL driver used for all pooled connections */
+static const QString DATABASE_TYPE = "QSQLITE";
+
+/* Prefix for the pooled connection names */
+static const QString CONNECTION_PREFIX = "LNMDBPOOL";
+
+DatabasePool::DatabasePool()
+{
+
+}
+
+DatabasePool::~DatabasePool()
+{
+  closeAll();
+}
+
+void DatabasePool::setDatabaseFiles(const QString& simFile, const QStringList& simPragmas,
+                                    const QString& navFile, const QStringList& navPragmas)
+{
+  closeAll();
+
+  QMutexLocker locker(&mutex);
+  databaseFileSim = simFile;
+  databaseFileNav = navFile;
+  databasePragmasSim = simPragmas;
+  databasePragmasNav = navPragmas;
+}
+
+void DatabasePool::closeAll()
+{
+  QMutexLocker locker(&mutex);
+
+  if(!connections.isEmpty())
+  {
+    // Connections belong to their threads - a worker is still running or did not call releaseThread
+    qWarning() << Q_FUNC_INFO << connections.size() << "threads still hold pooled connections";
+    Q_ASSERT_X(connections.isEmpty(), Q_FUNC_INFO, "Worker threads still hold pooled connections");
+
+    for(QThread *thread : connections.keys())
+      closeThread(thread);
+  }
+
+  databaseFileSim.clear();
+  databaseFileNav.clear();
+}
+
+void DatabasePool::releaseThread()
+{
+  QMutexLocker locker(&mutex);
+  closeThread(QThread::currentThread());
+}
+
+SqlDatabase *DatabasePool::getDatabase(dbpool::DatabaseType type)
+{
+  QMutexLocker locker(&mutex);
+
+  QThread *thread = QThread::currentThread();
+  ThreadConnections conns = connections.value(thread);
+  SqlDatabase *db = type == dbpool::SIM ? conns.sim : conns.nav;
+
+  if(db == nullptr)
+  {
+    QString file = type == dbpool::SIM ? databaseFileSim : databaseFileNav;
+    if(file.isEmpty())
+      return nullptr;
+
+    QString name = CONNECTION_PREFIX + "_" + (type == dbpool::SIM ? "SIM" : "NAV") + "_" +
+                   QString::number(nextConnectionId++);
+    qDebug() << Q_FUNC_INFO << "Opening pooled connection" << name << file;
+
+    SqlDatabase::addDatabase(DATABASE_TYPE, name);
+    db = new SqlDatabase(name);
+    try
+    {
+      db->setDatabaseName(file);
+      db->setReadonly();
+      db->open(type == dbpool::SIM ? databasePragmasSim : databasePragmasNav);
+    }
+    catch(...)
+    {
+      closeDatabase(db, name);
+      throw;
+    }
+
+    if(type == dbpool::SIM)
+    {
+      conns.sim = db;
+      conns.simName = name;
+    }
+    else
+    {
+      conns.nav = db;
+      conns.navName = name;
+    }
+
+    if(!conns.finished)
+      // Emitted and called in the finishing thread which allows to close the connections there
+      conns.finished = QObject::connect(thread, &QThread::finished, [this, thread]()
+      {
+        QMutexLocker finishedLocker(&mutex);
+        closeThread(thread);
+      });
+
+    connections.insert(thread, conns);
+  }
+  return db;
+}
+
+void DatabasePool::closeThread(QThread *thread)
+{
+  if(connections.contains(thread))
+  {
+    ThreadConnections conns = connections.take(thread);
+    QObject::disconnect(conns.finished);
+
+    if(conns.sim != nullptr)
+      closeDatabase(conns.sim, conns.simName);
+    if(conns.nav != nullptr)
+      closeDatabase(conns.nav, conns.navName);
+  }
+}
+
+void DatabasePool::closeDatabase(SqlDatabase *db, const QString& name)
+{
+  qDebug() << Q_FUNC_INFO << "Closing pooled connection" << name;
+
+  if(db->isOpen())
+    db->close();
+  delete db;
+
+  SqlDatabase::removeDatabase(name);
+}
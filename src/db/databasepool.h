@@ -0,0 +1,106 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLENAVMAP_DATABASEPOOL_H
+#define LITTLENAVMAP_DATABASEPOOL_H
+
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QStringList>
+
+class QThread;
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+}
+}
+
+namespace dbpool {
+
+/* Database file behind a pooled connection. Same files as used by DatabaseManager for the GUI thread. */
+enum DatabaseType
+{
+  SIM, /* Simulator database or navdata if all navdata is used */
+  NAV /* Navdata database or simulator database if navdata is off */
+};
+
+}
+
+/*
+ * Hands out read-only connections to the currently opened simulator and navdata databases for worker threads.
+ * Each thread gets its own connection per database file which is opened on first use.
+ * Connections are owned by the QThread object and closed by releaseThread or latest when the thread finishes.
+ *
+ * Query classes like InfoQuery, AirspaceQuery or RouteNetwork can be instantiated with a pooled connection
+ * to run outside of the GUI thread.
+ *
+ * All workers have to be finished and released before the database is switched or reloaded.
+ *
+ * All methods are thread safe.
+ */
+class DatabasePool
+{
+public:
+  DatabasePool();
+  ~DatabasePool();
+
+  /* Set database files and pragmas for new connections. Closes all open connections. */
+  void setDatabaseFiles(const QString& simFile, const QStringList& simPragmas,
+                        const QString& navFile, const QStringList& navPragmas);
+
+  /* Close and remove all connections. No worker thread may hold a connection when this is called. */
+  void closeAll();
+
+  /* Get a read-only connection for the calling thread. Opens the connection if not already done.
+   * Returns null if no database files were set. Throws exceptions on error.
+   * Queries have to be created and deleted by the caller in the same thread. */
+  atools::sql::SqlDatabase *getDatabase(dbpool::DatabaseType type);
+
+  /* Close and remove all connections of the calling thread. Has to be called at the end of each worker task. */
+  void releaseThread();
+
+private:
+  /* Connections of one thread */
+  struct ThreadConnections
+  {
+    atools::sql::SqlDatabase *sim = nullptr, *nav = nullptr;
+    QString simName, navName;
+
+    /* Closes connections if the thread finishes without calling releaseThread */
+    QMetaObject::Connection finished;
+  };
+
+  /* Close connections of the given thread. Mutex has to be locked. */
+  void closeThread(QThread *thread);
+  static void closeDatabase(atools::sql::SqlDatabase *db, const QString& name);
+
+  QString databaseFileSim, databaseFileNav;
+  QStringList databasePragmasSim, databasePragmasNav;
+
+  /* Keyed by thread object since native thread ids can be reused */
+  QHash<QThread *, ThreadConnections> connections;
+
+  /* Used to build unique connection names */
+  quint64 nextConnectionId = 0;
+
+  /* Protects the connection hash and file names - not the connections themselves */
+  mutable QMutex mutex;
+};
+
+#endif // LITTLENAVMAP_DATABASEPOOL_H
@@ -73,7 +73,12 @@ int CsvExporter::exportAll(bool open)
       // Run the current query to get all results - not only the visible
       atools::sql::SqlDatabase *db = controller->getSqlDatabase();
       SqlQuery query(db);
-      query.exec(controller->getCurrentSqlQuery());
+      query.prepare(controller->getCurrentSqlQuery());
+
+      const QVariantMap bindValues = controller->getCurrentSqlQueryBindValues();
+      for(auto it = bindValues.constBegin(); it != bindValues.constEnd(); ++it)
+        query.bindValue(it.key(), it.value());
+      query.exec();
 
       SqlExport sqlExport;
       sqlExport.setSeparatorChar(';');
@@ -173,30 +178,37 @@ int CsvExporter::selectionAsCsv(QTableView *view, bool header, bool rows, QStrin
       // Copy full rows
       QTextStream stream(&result, QIODevice::WriteOnly);
       QHeaderView *headerView = view->horizontalHeader();
+
+      // Resolve visible columns in visual order once instead of for each cell
+      QVector<int> logicalColumns;
+      for(int i = 0; i < model->columnCount(); i++)
+        if(!view->isColumnHidden(i))
+          logicalColumns.append(headerView->logicalIndex(i));
+
+      bool addFields = !additionalHeader.isEmpty() && additionalFields;
       if(header)
       {
         // Build CSV header
         QStringList headers;
-        for(int i = 0; i < model->columnCount(); i++)
-          if(!view->isColumnHidden(i))
-            headers.append(model->headerData(headerView->logicalIndex(i), Qt::Horizontal).
-                           toString().replace("-\n", "").replace("\n", " "));
+        for(int col : logicalColumns)
+          headers.append(model->headerData(col, Qt::Horizontal).toString().replace("-\n", "").replace("\n", " "));
 
         stream << exporter.getResultSetHeader(headers) +
-        (additionalHeader.isEmpty() || !additionalFields ? QString() : ";" + additionalHeader.join(";")) << endl;
+        (addFields ? ";" + additionalHeader.join(";") : QString()) << endl;
       }
 
+      QVariantList vars;
+      vars.reserve(logicalColumns.size());
       for(QItemSelectionRange rng : selection->selection())
       {
         // Add data
         for(int row = rng.top(); row <= rng.bottom(); ++row)
         {
-          QVariantList vars;
-          for(int i = 0; i < model->columnCount(); i++)
-            if(!view->isColumnHidden(i))
-              vars.append(model->data(model->index(row, headerView->logicalIndex(i))));
+          vars.clear();
+          for(int col : logicalColumns)
+            vars.append(model->data(model->index(row, col)));
           stream << exporter.getResultSetRow(vars) +
-          (additionalHeader.isEmpty() || !additionalFields ? QString() : ";" + additionalFields(row).join(";")) << endl;
+          (addFields ? ";" + additionalFields(row).join(";") : QString()) << endl;
 
           exported++;
         }
@@ -111,7 +111,12 @@ int HtmlExporter::exportAll(bool open)
   // Run the current query to get all results - not only the visible
   atools::sql::SqlDatabase *db = controller->getSqlDatabase();
   SqlQuery query(db);
-  query.exec(controller->getCurrentSqlQuery());
+  query.prepare(controller->getCurrentSqlQuery());
+
+  const QVariantMap bindValues = controller->getCurrentSqlQueryBindValues();
+  for(auto it = bindValues.constBegin(); it != bindValues.constEnd(); ++it)
+    query.bindValue(it.key(), it.value());
+  query.exec();
   totalToExport = controller->getTotalRowCount();
   totalPages = static_cast<int>(std::ceil(static_cast<float>(totalToExport) / static_cast<float>(pageSize)));
 
@@ -22,6 +22,7 @@
 #include "navapp.h"
 #include "atools.h"
 #include "common/mapcolors.h"
+#include "common/symbolpainter.h"
 #include "gui/stylehandler.h"
 #include "fs/common/morareader.h"
 #include "gui/application.h"
@@ -39,6 +40,7 @@
 #include "logging/logginghandler.h"
 #include "logging/loggingguiabort.h"
 #include "query/airportquery.h"
+#include "query/mapquery.h"
 #include "mapgui/mapwidget.h"
 #include "mapgui/aprongeometrycache.h"
 #include "profile/profilewidget.h"
@@ -735,6 +737,7 @@ void MainWindow::connectAllSlots()
   connect(optionsDialog, &OptionsDialog::optionsChanged, weatherReporter, &WeatherReporter::optionsChanged);
   connect(optionsDialog, &OptionsDialog::optionsChanged, searchController, &SearchController::optionsChanged);
   connect(optionsDialog, &OptionsDialog::optionsChanged, map::updateUnits);
+  connect(optionsDialog, &OptionsDialog::optionsChanged, &SymbolPainter::invalidateSymbolAtlas);
   connect(optionsDialog, &OptionsDialog::optionsChanged, routeController, &RouteController::optionsChanged);
   connect(optionsDialog, &OptionsDialog::optionsChanged, infoController, &InfoController::optionsChanged);
   connect(optionsDialog, &OptionsDialog::optionsChanged, mapWidget, &MapWidget::optionsChanged);
@@ -746,6 +749,7 @@ void MainWindow::connectAllSlots()
 
   // Style handler ===================================================================
   connect(NavApp::getStyleHandler(), &StyleHandler::styleChanged, mapcolors::styleChanged);
+  connect(NavApp::getStyleHandler(), &StyleHandler::styleChanged, &SymbolPainter::invalidateSymbolAtlas);
   connect(NavApp::getStyleHandler(), &StyleHandler::styleChanged, infoController, &InfoController::optionsChanged);
   connect(NavApp::getStyleHandler(), &StyleHandler::styleChanged, routeController, &RouteController::styleChanged);
   connect(NavApp::getStyleHandler(), &StyleHandler::styleChanged, searchController, &SearchController::styleChanged);
@@ -774,6 +778,10 @@ void MainWindow::connectAllSlots()
   connect(routeController, &RouteController::routeAltitudeChanged, profileWidget, &ProfileWidget::routeAltitudeChanged);
   connect(routeController, &RouteController::routeChanged, this, &MainWindow::updateActionStates);
 
+  // Load procedures of departure and destination in background
+  connect(routeController, &RouteController::routeChanged, NavApp::getProcedureQuery(),
+          &ProcedureQuery::routeChanged);
+
   // Airport search ===================================================================================
   AirportSearch *airportSearch = searchController->getAirportSearch();
   connect(airportSearch, &SearchBaseTable::showRect, mapWidget, &MapWidget::showRect);
@@ -826,6 +834,8 @@ void MainWindow::connectAllSlots()
 
   connect(userdataController, &UserdataController::userdataChanged, infoController,
           &InfoController::updateAllInformation);
+  connect(userdataController, &UserdataController::userdataChanged,
+          NavApp::getMapQuery(), &MapQuery::userdataChanged);
   connect(userdataController, &UserdataController::userdataChanged, this, &MainWindow::updateMapObjectsShown);
   connect(userdataController, &UserdataController::refreshUserdataSearch, userSearch, &UserdataSearch::refreshData);
 
@@ -1129,6 +1139,7 @@ void MainWindow::connectAllSlots()
 
   connect(NavApp::getDatabaseManager(), &DatabaseManager::preDatabaseLoad, this, &MainWindow::preDatabaseLoad);
   connect(NavApp::getDatabaseManager(), &DatabaseManager::postDatabaseLoad, this, &MainWindow::postDatabaseLoad);
+  connect(NavApp::getDatabaseManager(), &DatabaseManager::compilingChanged, this, &MainWindow::updateActionStates);
 
   // Not needed. All properties removed from legend since they are not persistent
   // connect(legendWidget, &Marble::LegendWidget::propertyValueChanged,
@@ -2547,7 +2558,9 @@ void MainWindow::updateActionStates()
   ui->actionMapShowMark->setEnabled(mapWidget->getSearchMarkPos().isValid());
 
   // Allow to copy airspaces to X-Plane if the currently selected is FSX/P3D and the X-Plane path is set
+  // Target database might be compiled in background
   ui->actionReloadSceneryCopyAirspaces->setEnabled(
+    !NavApp::getDatabaseManager()->isCompiling() &&
     NavApp::getCurrentSimulatorDb() != atools::fs::FsPaths::XPLANE11 &&
     !NavApp::getSimulatorBasePath(atools::fs::FsPaths::XPLANE11).isEmpty());
 }
@@ -22,6 +22,7 @@
 #include "common/constants.h"
 #include "common/htmlinfobuilder.h"
 #include "online/onlinedatacontroller.h"
+#include "connect/connectclient.h"
 #include "gui/mainwindow.h"
 #include "gui/widgetutil.h"
 #include "gui/widgetstate.h"
@@ -46,6 +47,7 @@
 #include <QMessageBox>
 #include <QDir>
 #include <QTabWidget>
+#include <QTextDocument>
 
 #ifdef Q_OS_WIN32
 #include <windows.h>
@@ -148,10 +150,11 @@ void InfoController::currentInfoTabChanged(int index)
   switch(static_cast<ic::TabIndex>(index))
   {
     case ic::INFO_AIRPORT:
-      updateAirportInternal(false /* new */, true /* bearing changed */, false /* scroll to top */);
+      updateAirportInternal(false /* new */, true /* bearing changed */, true /* force */, false /* scroll to top */);
       break;
     case ic::INFO_NAVAID:
-      updateNavaidInternal(currentSearchResult, true /* bearing changed */, false /* scroll to top */);
+      updateNavaidInternal(currentSearchResult, true /* bearing changed */, true /* force */,
+                           false /* scroll to top */);
       break;
     case ic::INFO_RUNWAYS:
     case ic::INFO_COM:
@@ -368,7 +371,7 @@ void InfoController::restoreState()
 
 void InfoController::updateAirport()
 {
-  updateAirportInternal(false /* new */, false /* bearing change*/, false /* scroll to top */);
+  updateAirportInternal(false /* new */, false /* bearing change*/, false /* force */, false /* scroll to top */);
 }
 
 void InfoController::updateProgress()
@@ -381,11 +384,11 @@ void InfoController::updateProgress()
     // ok - scrollbars not pressed
     html.clear();
     infoBuilder->aircraftProgressText(lastSimData.getUserAircraftConst(), html, NavApp::getRouteConst());
-    atools::gui::util::updateTextEdit(ui->textBrowserAircraftProgressInfo, html.getHtml());
+    updateTextEditCached(ui->textBrowserAircraftProgressInfo, html.getHtml());
   }
 }
 
-void InfoController::updateAirportInternal(bool newAirport, bool bearingChange, bool scrollToTop)
+void InfoController::updateAirportInternal(bool newAirport, bool bearingChange, bool forceUpdate, bool scrollToTop)
 {
   if(databaseLoadStatus)
     return;
@@ -401,33 +404,36 @@ void InfoController::updateAirportInternal(bool newAirport, bool bearingChange,
 
     if(newAirport || weatherChanged || bearingChange)
     {
-      HtmlBuilder html(true);
-      map::MapAirport airport;
-      airportQuery->getAirportById(airport, currentSearchResult.airports.first().id);
+      const map::MapAirport& resultAirport = currentSearchResult.airports.first();
+
+      // Nothing to do on aircraft updates if the shown bearing and distance texts are still the same
+      QString bearingKey = infoBuilder->bearingAndDistanceTexts(resultAirport.position, resultAirport.magvar);
+      if(!newAirport && !weatherChanged && !forceUpdate && bearingKey == lastAirportBearingKey)
+        return;
+      lastAirportBearingKey = bearingKey;
+
+      // Load airport only if changed - otherwise reuse the last query result
+      if(newAirport || currentAirport.id != resultAirport.id)
+        airportQuery->getAirportById(currentAirport, resultAirport.id);
+      const map::MapAirport& airport = currentAirport;
 
       // qDebug() << Q_FUNC_INFO << "Updating html" << airport.ident << airport.id;
 
+      HtmlBuilder html(true);
       infoBuilder->airportText(airport, currentWeatherContext, html, &NavApp::getRouteConst());
 
       Ui::MainWindow *ui = NavApp::getMainUi();
-      if(scrollToTop)
-        // scroll up for new airports
-        ui->textBrowserAirportInfo->setText(html.getHtml());
-      else
-        // Leave position for weather or bearing updates
-        atools::gui::util::updateTextEdit(ui->textBrowserAirportInfo, html.getHtml());
+
+      // Scroll up for new airports or leave position for weather or bearing updates
+      updateTextEditCached(ui->textBrowserAirportInfo, html.getHtml(), scrollToTop);
 
       if(newAirport || weatherChanged)
       {
         html.clear();
         infoBuilder->weatherText(currentWeatherContext, airport, html);
 
-        if(scrollToTop)
-          // scroll up for new airports
-          ui->textBrowserWeatherInfo->setText(html.getHtml());
-        else
-          // Leave position for weather updates
-          atools::gui::util::updateTextEdit(ui->textBrowserWeatherInfo, html.getHtml());
+        // Scroll up for new airports or leave position for weather updates
+        updateTextEditCached(ui->textBrowserWeatherInfo, html.getHtml(), scrollToTop);
       }
     }
   }
@@ -437,6 +443,10 @@ void InfoController::clearInfoTextBrowsers()
 {
   Ui::MainWindow *ui = NavApp::getMainUi();
 
+  lastHtml.clear();
+  lastAirportBearingKey.clear();
+  lastNavaidBearingKey.clear();
+
   ui->textBrowserAirportInfo->clear();
   ui->textBrowserRunwayInfo->clear();
   ui->textBrowserComInfo->clear();
@@ -561,7 +571,7 @@ void InfoController::showInformationInternal(map::MapSearchResult result, map::M
     // Remember one airport
     currentSearchResult.airports.append(airport);
 
-    updateAirportInternal(true /* new */, false /* bearing change*/, scrollToTop);
+    updateAirportInternal(true /* new */, false /* bearing change*/, false /* force */, scrollToTop);
 
     html.clear();
     infoBuilder->runwayText(airport, html);
@@ -639,7 +649,7 @@ void InfoController::showInformationInternal(map::MapSearchResult result, map::M
     // if any navaids are to be shown clear search result before
     currentSearchResult.clear(map::NAV_ALL | map::USERPOINT | map::ILS | map::AIRWAY | map::RUNWAYEND);
 
-  foundNavaid = updateNavaidInternal(result, false /* bearing changed */, scrollToTop);
+  foundNavaid = updateNavaidInternal(result, false /* bearing changed */, false /* force */, scrollToTop);
 
   // Show dock windows if needed
   if(showWindows)
@@ -748,8 +758,16 @@ void InfoController::showInformationInternal(map::MapSearchResult result, map::M
   }
 }
 
-bool InfoController::updateNavaidInternal(const map::MapSearchResult& result, bool bearingChanged, bool scrollToTop)
+bool InfoController::updateNavaidInternal(const map::MapSearchResult& result, bool bearingChanged, bool forceUpdate,
+                                          bool scrollToTop)
 {
+  QString bearingKey = navaidBearingKey(result);
+  if(bearingChanged && !forceUpdate && bearingKey == lastNavaidBearingKey)
+    // Shown bearing and distance texts did not change - avoid queries and rebuilding the page
+    return !result.userpoints.isEmpty() || !result.vors.isEmpty() || !result.ndbs.isEmpty() ||
+           !result.waypoints.isEmpty() || !result.airways.isEmpty();
+  lastNavaidBearingKey = bearingKey;
+
   HtmlBuilder html(true);
   Ui::MainWindow *ui = NavApp::getMainUi();
   bool foundNavaid = false;
@@ -814,20 +832,44 @@ bool InfoController::updateNavaidInternal(const map::MapSearchResult& result, bo
   }
 
   if(foundNavaid)
-  {
-    if(scrollToTop)
-      ui->textBrowserNavaidInfo->setText(html.getHtml());
-    else
-      atools::gui::util::updateTextEdit(ui->textBrowserNavaidInfo, html.getHtml());
-  }
+    updateTextEditCached(ui->textBrowserNavaidInfo, html.getHtml(), scrollToTop);
 
   return foundNavaid;
 }
 
+QString InfoController::navaidBearingKey(const map::MapSearchResult& result) const
+{
+  QStringList key;
+  for(const map::MapUserpoint& userpoint: result.userpoints)
+    key.append(infoBuilder->bearingAndDistanceTexts(userpoint.position, NavApp::getMagVar(userpoint.position)));
+  for(const map::MapVor& vor : result.vors)
+    key.append(infoBuilder->bearingAndDistanceTexts(vor.position, vor.magvar));
+  for(const map::MapNdb& ndb : result.ndbs)
+    key.append(infoBuilder->bearingAndDistanceTexts(ndb.position, ndb.magvar));
+  for(const map::MapWaypoint& waypoint : result.waypoints)
+    key.append(infoBuilder->bearingAndDistanceTexts(waypoint.position, waypoint.magvar));
+  return key.join(QChar('\n'));
+}
+
+void InfoController::updateTextEditCached(QTextEdit *textEdit, const QString& html, bool scrollToTop)
+{
+  if(scrollToTop)
+    textEdit->setText(html);
+  else if(textEdit->document()->isEmpty() || lastHtml.value(textEdit) != html)
+    // Replace document and keep scroll position
+    atools::gui::util::updateTextEdit(textEdit, html);
+  else
+    // Same content - avoid parsing and layout
+    return;
+
+  lastHtml.insert(textEdit, html);
+}
+
 void InfoController::preDatabaseLoad()
 {
   // Clear current airport and navaids result
   currentSearchResult = map::MapSearchResult();
+  currentAirport = map::MapAirport();
   databaseLoadStatus = true;
   clearInfoTextBrowsers();
 }
@@ -855,14 +897,20 @@ void InfoController::updateUserAircraftText()
         HtmlBuilder html(true /* has background color */);
         infoBuilder->aircraftText(lastSimData.getUserAircraftConst(), html);
         infoBuilder->aircraftTextWeightAndFuel(lastSimData.getUserAircraftConst(), html);
-        atools::gui::util::updateTextEdit(ui->textBrowserAircraftInfo, html.getHtml());
+        updateTextEditCached(ui->textBrowserAircraftInfo, html.getHtml());
       }
     }
     else
+    {
+      lastHtml.remove(ui->textBrowserAircraftInfo);
       ui->textBrowserAircraftInfo->setPlainText(tr("Connected. Waiting for update."));
+    }
   }
   else
+  {
+    lastHtml.remove(ui->textBrowserAircraftInfo);
     ui->textBrowserAircraftInfo->clear();
+  }
 }
 
 void InfoController::updateAircraftProgressText()
@@ -881,14 +929,20 @@ void InfoController::updateAircraftProgressText()
         // ok - scrollbars not pressed
         HtmlBuilder html(true /* has background color */);
         infoBuilder->aircraftProgressText(lastSimData.getUserAircraftConst(), html, NavApp::getRouteConst());
-        atools::gui::util::updateTextEdit(ui->textBrowserAircraftProgressInfo, html.getHtml());
+        updateTextEditCached(ui->textBrowserAircraftProgressInfo, html.getHtml());
       }
     }
     else
+    {
+      lastHtml.remove(ui->textBrowserAircraftProgressInfo);
       ui->textBrowserAircraftProgressInfo->setPlainText(tr("Connected. Waiting for update."));
+    }
   }
   else
+  {
+    lastHtml.remove(ui->textBrowserAircraftProgressInfo);
     ui->textBrowserAircraftProgressInfo->clear();
+  }
 }
 
 void InfoController::updateAiAircraftText()
@@ -917,7 +971,7 @@ void InfoController::updateAiAircraftText()
             num++;
           }
 
-          atools::gui::util::updateTextEdit(ui->textBrowserAircraftAiInfo, html.getHtml());
+          updateTextEditCached(ui->textBrowserAircraftAiInfo, html.getHtml());
         }
         else
         {
@@ -930,15 +984,21 @@ void InfoController::updateAiAircraftText()
           text += tr("No AI or multiplayer aircraft selected.<br/>"
                      "Found %1 AI or multiplayer aircraft.").
                   arg(numAi > 0 ? QLocale().toString(numAi) : tr("no"));
-          atools::gui::util::updateTextEdit(ui->textBrowserAircraftAiInfo, text);
+          updateTextEditCached(ui->textBrowserAircraftAiInfo, text);
         }
       }
     }
     else
+    {
+      lastHtml.remove(ui->textBrowserAircraftAiInfo);
       ui->textBrowserAircraftAiInfo->setPlainText(tr("Connected. Waiting for update."));
+    }
   }
   else
+  {
+    lastHtml.remove(ui->textBrowserAircraftAiInfo);
     ui->textBrowserAircraftAiInfo->clear();
+  }
 }
 
 void InfoController::simDataChanged(atools::fs::sc::SimConnectData data)
@@ -976,10 +1036,11 @@ void InfoController::simDataChanged(atools::fs::sc::SimConnectData data)
     if(data.getUserAircraftConst().isValid() && ui->dockWidgetInformation->isVisible())
     {
       if(ui->tabWidgetInformation->currentIndex() == ic::INFO_AIRPORT)
-        updateAirportInternal(false /* new */, true /* bearing change*/, false /* scroll to top */);
+        updateAirportInternal(false /* new */, true /* bearing change*/, false /* force */, false /* scroll to top */);
 
       if(ui->tabWidgetInformation->currentIndex() == ic::INFO_NAVAID)
-        updateNavaidInternal(currentSearchResult, true /* bearing changed */, false /* scroll to top */);
+        updateNavaidInternal(currentSearchResult, true /* bearing changed */, false /* force */,
+                             false /* scroll to top */);
     }
     lastSimBearingUpdate = QDateTime::currentDateTime().toMSecsSinceEpoch();
   }
@@ -994,16 +1055,13 @@ void InfoController::updateAiAirports(const atools::fs::sc::SimConnectData& data
     QVector<atools::fs::sc::SimConnectAircraft> newAiAircraftShown;
 
     // Find all aircraft currently shown on the page in the newly arrived ai list
-    for(SimConnectAircraft& aircraft : currentSearchResult.aiAircraft)
+    // using the object id index built once per packet
+    const ConnectClient *connectClient = NavApp::getConnectClient();
+    for(const SimConnectAircraft& aircraft : currentSearchResult.aiAircraft)
     {
-      QVector<atools::fs::sc::SimConnectAircraft>::const_iterator it =
-        std::find_if(newAiAircraft.begin(), newAiAircraft.end(),
-                     [ = ](const SimConnectAircraft& ac) -> bool
-      {
-        return ac.getObjectId() == aircraft.getObjectId();
-      });
-      if(it != newAiAircraft.end())
-        newAiAircraftShown.append(*it);
+      int index = connectClient->getAiAircraftIndexById(aircraft.getObjectId());
+      if(index >= 0 && index < newAiAircraft.size() && newAiAircraft.at(index).getObjectId() == aircraft.getObjectId())
+        newAiAircraftShown.append(newAiAircraft.at(index));
     }
 
     // Overwite old list
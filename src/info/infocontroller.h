@@ -120,8 +120,17 @@ private:
   /* Bearing update in information window time limit */
   static Q_DECL_CONSTEXPR int MIN_SIM_UPDATE_BEARING_TIME_MS = 1000;
 
-  void updateAirportInternal(bool newAirport, bool bearingChange, bool scrollToTop);
-  bool updateNavaidInternal(const map::MapSearchResult& result, bool bearingChanged, bool scrollToTop);
+  /* Bearing updates are skipped if the shown bearing and distance texts did not change unless forceUpdate is true */
+  void updateAirportInternal(bool newAirport, bool bearingChange, bool forceUpdate, bool scrollToTop);
+  bool updateNavaidInternal(const map::MapSearchResult& result, bool bearingChanged, bool forceUpdate,
+                            bool scrollToTop);
+
+  /* Replace text edit content keeping the scroll position. Does nothing if the HTML is the same
+   * as in the last call for this text edit. */
+  void updateTextEditCached(QTextEdit *textEdit, const QString& html, bool scrollToTop = false);
+
+  /* Bearing and distance texts for currently shown objects. Used to detect bearing changes. */
+  QString navaidBearingKey(const map::MapSearchResult& result) const;
 
   void updateTextEditFontSizes();
   void setTextEditFontSize(QTextEdit *textEdit, float origSize, int percent);
@@ -151,6 +160,15 @@ private:
   /* Airport and navaids that are currently shown in the tabs */
   map::MapSearchResult currentSearchResult;
 
+  /* Fully loaded airport for currentSearchResult to avoid queries on bearing updates */
+  map::MapAirport currentAirport;
+
+  /* Bearing and distance texts of the last update for airport and navaid tabs */
+  QString lastAirportBearingKey, lastNavaidBearingKey;
+
+  /* Last HTML set by updateTextEditCached */
+  QHash<const QTextEdit *, QString> lastHtml;
+
   MainWindow *mainWindow = nullptr;
   MapQuery *mapQuery = nullptr;
   AirspaceQuery *airspaceQuery = nullptr;
@@ -19,24 +19,47 @@
 #include "fs/common/xpgeometry.h"
 #include "common/coordinateconverter.h"
 #include "common/maptypes.h"
+#include "common/constants.h"
+#include "settings/settings.h"
+#include "geo/calculations.h"
 
+#include <QDebug>
 #include <QPainterPath>
+#include <QTransform>
+
+#include <cmath>
+
+using atools::geo::Pos;
+
+/* Meter per degree latitude - good enough for the small extent of an airport */
+static const double METER_PER_DEGREE = 111319.5;
+
+/* Tolerance for dropping vertices is zoom distance of the bucket multiplied by this */
+static const float TOLERANCE_FACTOR = 1.f / 4000.f;
+
+/* Airport diagram zoom buckets used for pre-warming. Zoom distance is 2^bucket meter. */
+static const int PREWARM_MIN_BUCKET = 8;
+static const int PREWARM_MAX_BUCKET = 12;
+
+/* Distance for calculating the local frame to screen transformation */
+static const float TRANSFORM_DISTANCE_METER = 100.f;
 
 // ======= Key  ===============================================================
 uint qHash(const ApronGeometryCache::Key& key)
 {
-  return static_cast<uint>(key.apronId) ^ key.fast ^ static_cast<uint>(key.zoomDistanceMeter);
+  return static_cast<uint>(key.apronId) ^ (static_cast<uint>(key.fast) << 31) ^
+         (static_cast<uint>(key.zoomBucket) << 24);
 }
 
-ApronGeometryCache::Key::Key(int apronIdParam, float zoomDistanceMeterParam, bool fastParam)
-  : apronId(apronIdParam), zoomDistanceMeter(static_cast<int>(zoomDistanceMeterParam)), fast(fastParam)
+ApronGeometryCache::Key::Key(int apronIdParam, int zoomBucketParam, bool fastParam)
+  : apronId(apronIdParam), zoomBucket(zoomBucketParam), fast(fastParam)
 {
 
 }
 
 bool ApronGeometryCache::Key::operator==(const ApronGeometryCache::Key& other) const
 {
-  return apronId == other.apronId && fast == other.fast && zoomDistanceMeter == other.zoomDistanceMeter;
+  return apronId == other.apronId && fast == other.fast && zoomBucket == other.zoomBucket;
 }
 
 bool ApronGeometryCache::Key::operator!=(const ApronGeometryCache::Key& other) const
@@ -46,9 +69,9 @@ bool ApronGeometryCache::Key::operator!=(const ApronGeometryCache::Key& other) c
 
 // ======= ApronGeometryCache ===============================================================
 ApronGeometryCache::ApronGeometryCache()
-  : geometryCache(CACHE_SIZE)
 {
-
+  geometryCache.setMaxCost(atools::settings::Settings::instance().
+                           getAndStoreValue(lnm::SETTINGS_MAPQUERY + "ApronCacheKb", 20000).toInt());
 }
 
 ApronGeometryCache::~ApronGeometryCache()
@@ -66,71 +89,141 @@ void ApronGeometryCache::setViewportParams(const Marble::ViewportParams *viewpor
   if(converter != nullptr)
     delete converter;
 
-  // Create a new converter for the viewport
+  // Create a new converter for the viewport - cached paths do not depend on it
   converter = new CoordinateConverter(viewport);
 }
 
+int ApronGeometryCache::zoomBucket(float zoomDistanceMeter)
+{
+  // One bucket per octave
+  return static_cast<int>(std::floor(std::log2(std::max(zoomDistanceMeter, 1.f))));
+}
+
+int ApronGeometryCache::pathCost(const QPainterPath& path)
+{
+  // QPainterPath::Element is two doubles and a type
+  return std::max(1, static_cast<int>((path.elementCount() * sizeof(QPainterPath::Element) +
+                                       sizeof(QPainterPath)) / 1024));
+}
+
+QPointF ApronGeometryCache::toLocal(const Pos& pos, const Pos& ref)
+{
+  double dlon = pos.getLonX() - ref.getLonX();
+
+  // Correct for anti-meridian
+  if(dlon > 180.)
+    dlon -= 360.;
+  else if(dlon < -180.)
+    dlon += 360.;
+
+  return QPointF(dlon * std::cos(atools::geo::toRadians(static_cast<double>(ref.getLatY()))) * METER_PER_DEGREE,
+                 (pos.getLatY() - ref.getLatY()) * METER_PER_DEGREE);
+}
+
+bool ApronGeometryCache::localToScreen(const Pos& ref, QTransform& transform) const
+{
+  // Reference point can be off screen while parts of the apron are visible - reject only if behind the globe
+  bool visible, hidden;
+  QPointF origin = converter->wToSF(ref, CoordinateConverter::DEFAULT_WTOS_SIZE, &visible, &hidden);
+  if(hidden)
+    return false;
+
+  // Screen vectors for one meter east and north at the reference point
+  QPointF east = (converter->wToSF(ref.endpoint(TRANSFORM_DISTANCE_METER, 90.f).normalize(),
+                                   CoordinateConverter::DEFAULT_WTOS_SIZE, &visible, &hidden) - origin) /
+                 TRANSFORM_DISTANCE_METER;
+  if(hidden)
+    return false;
+
+  QPointF north = (converter->wToSF(ref.endpoint(TRANSFORM_DISTANCE_METER, 0.f).normalize(),
+                                    CoordinateConverter::DEFAULT_WTOS_SIZE, &visible, &hidden) - origin) /
+                  TRANSFORM_DISTANCE_METER;
+  if(hidden)
+    return false;
+
+  transform.setMatrix(east.x(), east.y(), 0.,
+                      north.x(), north.y(), 0.,
+                      origin.x(), origin.y(), 1.);
+  return true;
+}
+
 QPainterPath ApronGeometryCache::getApronGeometry(const map::MapApron& apron, float zoomDistanceMeter, bool fast)
 {
   Q_ASSERT(converter != nullptr);
 
-#if !defined(DEBUG_NO_XP_APRON_CACHE)
+  if(apron.geometry.boundary.isEmpty())
+    return QPainterPath();
 
-  // Build key and get path from the cache
-  Key key(apron.apronId, zoomDistanceMeter, fast);
-  QPainterPath *painterPath = geometryCache.object(key);
+  QTransform transform;
+  if(!localToScreen(apron.geometry.boundary.first().node, transform))
+    return QPainterPath();
 
-  if(painterPath != nullptr)
-  {
-    // Found - create a copy and translate it to the needed coordinates
-    QPainterPath boundaryPath(*painterPath);
+#if !defined(DEBUG_NO_XP_APRON_CACHE)
+  const QPainterPath *path = localGeometry(apron, zoomBucket(zoomDistanceMeter), fast);
+  return path != nullptr ? transform.map(*path) : QPainterPath();
 
-    // Calculate the coordinates of the reference point (first one) and move the whole path into required place for drawing
-    bool visible;
-    QPointF refPoint = converter->wToSF(apron.geometry.boundary.first().node,
-                                        CoordinateConverter::DEFAULT_WTOS_SIZE, &visible);
-    boundaryPath.translate(refPoint.x(), refPoint.y());
+#else
+  Q_UNUSED(zoomDistanceMeter);
+  const Pos& ref = apron.geometry.boundary.first().node;
+  QPainterPath boundaryPath = pathForBoundary(apron.geometry.boundary, ref, 0.f, fast);
+  for(const atools::fs::common::Boundary& hole : apron.geometry.holes)
+    boundaryPath = boundaryPath.subtracted(pathForBoundary(hole, ref, 0.f, fast));
+  return transform.map(boundaryPath);
 
-    return boundaryPath;
-  }
-  else
 #endif
-  {
-    // qDebug() << Q_FUNC_INFO << "Creating new apron";
-
-    // Nothing in cache - create the apron boundary
-    QPainterPath boundaryPath = pathForBoundary(apron.geometry.boundary, fast);
+}
 
-    // Substract holes
-    for(atools::fs::common::Boundary hole : apron.geometry.holes)
-      boundaryPath = boundaryPath.subtracted(pathForBoundary(hole, fast));
+const QPainterPath *ApronGeometryCache::localGeometry(const map::MapApron& apron, int zoomBucket, bool fast)
+{
+  // Build key and get path from the cache
+  Key key(apron.apronId, zoomBucket, fast);
+  QPainterPath *painterPath = geometryCache.object(key);
 
-#if !defined(DEBUG_NO_XP_APRON_CACHE)
+  if(painterPath == nullptr)
+  {
+    // qDebug() << Q_FUNC_INFO << "Creating new apron";
 
-    // Calculate reference point (first)
-    bool visible;
-    QPointF refPoint = converter->wToSF(
-      apron.geometry.boundary.first().node, CoordinateConverter::DEFAULT_WTOS_SIZE, &visible);
+    // Nothing in cache - create the apron boundary relative to the first node
+    const Pos& ref = apron.geometry.boundary.first().node;
+    float toleranceMeter = std::pow(2.f, static_cast<float>(zoomBucket)) * TOLERANCE_FACTOR;
 
-    // Create a copy for the cache
-    painterPath = new QPainterPath(boundaryPath);
+    painterPath = new QPainterPath(pathForBoundary(apron.geometry.boundary, ref, toleranceMeter, fast));
 
-    // Move the whole path, so that the reference is at 0,0
-    painterPath->translate(-refPoint.x(), -refPoint.y());
+    // Substract holes
+    for(const atools::fs::common::Boundary& hole : apron.geometry.holes)
+      *painterPath = painterPath->subtracted(pathForBoundary(hole, ref, toleranceMeter, fast));
 
-    // Insert path with reference 0,0
-    geometryCache.insert(key, painterPath);
-#endif
+    int cost = pathCost(*painterPath);
+    if(!geometryCache.insert(key, painterPath, cost))
+    {
+      // Larger than the whole budget - path was deleted by the cache
+      qWarning() << Q_FUNC_INFO << "Apron" << apron.apronId << "exceeds cache budget" << cost << "kB";
+      return nullptr;
+    }
+  }
+  return painterPath;
+}
 
-    // Return copy with correct position for drawing
-    return boundaryPath;
+void ApronGeometryCache::preWarm(const QList<map::MapApron>& aprons)
+{
+#if !defined(DEBUG_NO_XP_APRON_CACHE)
+  for(const map::MapApron& apron : aprons)
+  {
+    if(!apron.geometry.boundary.isEmpty())
+    {
+      for(int bucket = PREWARM_MIN_BUCKET; bucket <= PREWARM_MAX_BUCKET; bucket++)
+        localGeometry(apron, bucket, false /* fast */);
+    }
   }
+#else
+  Q_UNUSED(aprons);
+#endif
 }
 
 /* Calculate X-Plane aprons including bezier curves */
-QPainterPath ApronGeometryCache::pathForBoundary(const atools::fs::common::Boundary& boundaryNodes, bool fast)
+QPainterPath ApronGeometryCache::pathForBoundary(const atools::fs::common::Boundary& boundaryNodes, const Pos& ref,
+                                                 float toleranceMeter, bool fast) const
 {
-  bool visible;
   QPainterPath apronPath;
   atools::fs::common::Node lastNode;
 
@@ -140,44 +233,58 @@ QPainterPath ApronGeometryCache::pathForBoundary(const atools::fs::common::Bound
   if(!boundary.isEmpty())
     boundary.append(boundary.first());
 
+  // Last point added to the path
+  QPointF lastPathPt;
+
   int i = 0;
   for(const atools::fs::common::Node& node : boundary)
   {
-    QPointF lastPt = converter->wToSF(lastNode.node, CoordinateConverter::DEFAULT_WTOS_SIZE, &visible);
-    QPointF pt = converter->wToSF(node.node, CoordinateConverter::DEFAULT_WTOS_SIZE, &visible);
+    QPointF lastPt = toLocal(lastNode.node, ref);
+    QPointF pt = toLocal(node.node, ref);
 
     if(i == 0)
+    {
       // First point
-      apronPath.moveTo(converter->wToS(node.node, CoordinateConverter::DEFAULT_WTOS_SIZE, &visible));
-    else if(fast)
-      // Use lines only for fast drawing
-      apronPath.lineTo(pt);
+      apronPath.moveTo(pt);
+      lastPathPt = pt;
+    }
+    else if(fast || (!lastNode.control.isValid() && !node.control.isValid()))
+    {
+      // Use lines only for fast drawing or no control point - simple line
+      // Skip points too close to the last one except the closing point
+      if(i == boundary.size() - 1 || std::abs(pt.x() - lastPathPt.x()) + std::abs(pt.y() - lastPathPt.y()) >
+         toleranceMeter)
+      {
+        apronPath.lineTo(pt);
+        lastPathPt = pt;
+      }
+    }
     else
     {
+      if(lastPathPt != lastPt)
+        // Previous line end was dropped - curves need the exact start point
+        apronPath.lineTo(lastPt);
+
       if(lastNode.control.isValid() && node.control.isValid())
       {
         // Two successive control points - use cubic curve
-        QPointF controlPoint1 = converter->wToSF(lastNode.control, CoordinateConverter::DEFAULT_WTOS_SIZE, &visible);
-        QPointF controlPoint2 = converter->wToSF(node.control, CoordinateConverter::DEFAULT_WTOS_SIZE, &visible);
+        QPointF controlPoint1 = toLocal(lastNode.control, ref);
+        QPointF controlPoint2 = toLocal(node.control, ref);
         apronPath.cubicTo(controlPoint1, pt + (pt - controlPoint2), pt);
       }
       else if(lastNode.control.isValid())
       {
         // One control point from last - use quad curve
         if(lastPt != pt)
-          apronPath.quadTo(converter->wToSF(lastNode.control,
-                                            CoordinateConverter::DEFAULT_WTOS_SIZE, &visible), pt);
+          apronPath.quadTo(toLocal(lastNode.control, ref), pt);
       }
       else if(node.control.isValid())
       {
         // One control point from current - use quad curve
         if(lastPt != pt)
-          apronPath.quadTo(pt + (pt - converter->wToSF(node.control,
-                                                       CoordinateConverter::DEFAULT_WTOS_SIZE, &visible)), pt);
+          apronPath.quadTo(pt + (pt - toLocal(node.control, ref)), pt);
       }
-      else
-        // No control point - simple line
-        apronPath.lineTo(pt);
+      lastPathPt = pt;
     }
 
     lastNode = node;
@@ -24,6 +24,7 @@
 #include <QPainterPath>
 
 class QPainterPath;
+class QTransform;
 class CoordinateConverter;
 namespace Marble {
 class ViewportParams;
@@ -34,9 +35,14 @@ struct MapApron;
 }
 
 /*
- * Caches the complex X-Plane apron geometry in screen coordinates by zoom level and draw fast flag.
+ * Caches the complex X-Plane apron geometry by zoom bucket and draw fast flag.
  *
- * This will keep a copy of a QPainterPath of an apron for a given zoomlevel until the cache overflows.
+ * Paths are stored in a local frame in meter relative to the first boundary node (x east, y north)
+ * and are therefore independent of the viewport. For drawing a path is mapped to screen coordinates
+ * using an affine transformation which is calculated for the reference node from the current projection.
+ *
+ * Zoom distances are grouped into buckets of one octave each. A bucket defines the tolerance
+ * for dropping vertices of straight edges. Total size is limited by a memory budget.
  */
 class ApronGeometryCache
 {
@@ -45,9 +51,13 @@ public:
   ~ApronGeometryCache();
 
   /* Get apron geometry in screen coordinates from the cache or create it from map::MapApron.
-   * Combined key is apron ID, zoom and draw fast flag */
+   * Combined key is apron ID, zoom bucket and draw fast flag */
   QPainterPath getApronGeometry(const map::MapApron& apron, float zoomDistanceMeter, bool fast);
 
+  /* Build and cache the geometry of the aprons for all airport diagram zoom buckets.
+   * Used for departure and destination of the flight plan. */
+  void preWarm(const QList<map::MapApron>& aprons);
+
   /* Clear the cache */
   void clear();
 
@@ -58,10 +68,10 @@ private:
   /* Cache key used to identify a QPainterPath for an apron */
   struct Key
   {
-    Key(int apronIdParam, float zoomDistanceMeterParam, bool fastParam);
+    Key(int apronIdParam, int zoomBucketParam, bool fastParam);
 
     int apronId;
-    int zoomDistanceMeter;
+    int zoomBucket;
     bool fast; /* Draw fast flag - no curves if true */
 
     bool operator!=(const ApronGeometryCache::Key& other) const;
@@ -71,14 +81,30 @@ private:
 
   friend uint qHash(const ApronGeometryCache::Key& key);
 
-  /* Calculate X-Plane aprons including bezier curves */
-  QPainterPath pathForBoundary(const atools::fs::common::Boundary& boundaryNodes, bool fast);
+  /* Get path in local frame from cache or build and insert it */
+  const QPainterPath *localGeometry(const map::MapApron& apron, int zoomBucket, bool fast);
+
+  /* Calculate X-Plane aprons including bezier curves in local frame.
+   * Vertices of straight edges closer than toleranceMeter to the last one are dropped. */
+  QPainterPath pathForBoundary(const atools::fs::common::Boundary& boundaryNodes, const atools::geo::Pos& ref,
+                               float toleranceMeter, bool fast) const;
+
+  /* Convert position to local frame in meter relative to ref */
+  static QPointF toLocal(const atools::geo::Pos& pos, const atools::geo::Pos& ref);
 
-  /* Some airport have more than 100 apron parts */
-  static const int CACHE_SIZE = 2000;
+  /* Calculate transformation from local frame to screen at position ref. Returns false if ref is hidden behind
+   * the globe. Off screen positions are valid since the apron might still be partially visible. */
+  bool localToScreen(const atools::geo::Pos& ref, QTransform& transform) const;
+
+  static int zoomBucket(float zoomDistanceMeter);
+
+  /* Cost in kB for the cache */
+  static int pathCost(const QPainterPath& path);
 
   /* Used to convert world to screen coordinates */
   CoordinateConverter *converter = nullptr;
+
+  /* Cost is kB */
   QCache<Key, QPainterPath> geometryCache;
 };
 
@@ -60,7 +60,7 @@ MapPainter::MapPainter(MapWidget *parentMapWidget, MapScale *mapScale)
   airspaceQuery = NavApp::getAirspaceQuery();
   airspaceQueryOnline = NavApp::getAirspaceQueryOnline();
   airportQuery = NavApp::getAirportQuerySim();
-  symbolPainter = new SymbolPainter();
+  symbolPainter = new SymbolPainter(true /* use atlas */);
 }
 
 MapPainter::~MapPainter()
@@ -91,39 +91,51 @@ void MapPainterAirport::render(PaintContext *context)
 
   // Get airports from cache/database for the bounding rectangle and add them to the map
   const GeoDataLatLonAltBox& curBox = context->viewport->viewLatLonAltBox();
-  const QList<MapAirport> *airportCache = nullptr;
+  const map::MapAirportColumns *airportCache = nullptr;
   if(context->mapLayerEffective->isAirportDiagram())
     airportCache = mapQuery->getAirports(curBox, context->mapLayerEffective, context->lazyUpdate);
   else
     airportCache = mapQuery->getAirports(curBox, context->mapLayer, context->lazyUpdate);
 
-  // Collect all airports that are visible
-  QList<PaintAirportType> visibleAirports;
-  for(const MapAirport& airport : *airportCache)
+  // Collect all airports that are on the screen by checking the compact columns
+  int minRunwayLength = context->mapLayer->getMinRunwayLength();
+  QVector<std::pair<int, QPointF> > airportsOnScreen;
+  for(int i = 0; i < airportCache->size(); i++)
   {
-    // Either part of the route or enabled in the actions/menus/toolbar
-    if(!airport.isVisible(context->objectTypes) && !routeAirportIdMap.contains(airport.id))
+    // Avoid drawing too many airports during animation when zooming out
+    if(airportCache->longestRunwayLengths.at(i) < minRunwayLength)
       continue;
 
-    // Avoid drawing too many airports during animation when zooming out
-    if(airport.longestRunwayLength >= context->mapLayer->getMinRunwayLength())
-    {
-      float x, y;
-      bool hidden;
-      bool visible = wToS(airport.position, x, y, scale->getScreeenSizeForRect(airport.bounding), &hidden);
+    const atools::geo::Rect& bounding = airportCache->boundings.at(i);
+    float x, y;
+    bool hidden;
+    bool visible = wToS(airportCache->positions.at(i), x, y, scale->getScreeenSizeForRect(bounding), &hidden);
 
-      if(!hidden)
-      {
-        if(!visible && context->mapLayer->isAirportOverviewRunway())
-          // Check bounding rect for visibility if relevant - not for point symbols
-          visible = airport.bounding.overlaps(context->viewportRect);
+    if(hidden)
+      continue;
 
-        airport.bounding.overlaps(context->viewportRect);
+    if(!visible && context->mapLayer->isAirportOverviewRunway())
+      // Check bounding rect for visibility if relevant - not for point symbols
+      visible = bounding.overlaps(context->viewportRect);
 
-        if(visible)
-          visibleAirports.append(std::make_pair(&airport, QPointF(x, y)));
-      }
-    }
+    if(visible)
+      airportsOnScreen.append(std::make_pair(i, QPointF(x, y)));
+  }
+
+  // Create full objects only for airports on the screen - reserve to keep pointers valid
+  QVector<MapAirport> airports;
+  airports.reserve(airportsOnScreen.size());
+  QList<PaintAirportType> visibleAirports;
+  for(const std::pair<int, QPointF>& airportOnScreen : airportsOnScreen)
+  {
+    airports.append(airportCache->airport(airportOnScreen.first));
+    const MapAirport& airport = airports.last();
+
+    // Either part of the route or enabled in the actions/menus/toolbar
+    if(!airport.isVisible(context->objectTypes) && !routeAirportIdMap.contains(airport.id))
+      airports.removeLast();
+    else
+      visibleAirports.append(std::make_pair(&airport, airportOnScreen.second));
   }
 
   const OptionData& od = OptionData::instance();
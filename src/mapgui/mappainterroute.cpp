@@ -31,6 +31,7 @@
 #include <QBitArray>
 #include <marble/GeoDataLineString.h>
 #include <marble/GeoPainter.h>
+#include <marble/ViewportParams.h>
 
 using namespace Marble;
 using namespace atools::geo;
@@ -46,7 +47,81 @@ MapPainterRoute::MapPainterRoute(MapWidget *mapWidget, MapScale *mapScale, const
 
 MapPainterRoute::~MapPainterRoute()
 {
+  delete routeTextPlacement;
+}
+
+bool MapPainterRoute::RouteGeometryKey::operator==(const MapPainterRoute::RouteGeometryKey& other) const
+{
+  return routeHash == other.routeHash && atools::almostEqual(centerLon, other.centerLon) &&
+         atools::almostEqual(centerLat, other.centerLat) && atools::almostEqual(radius, other.radius) &&
+         width == other.width && height == other.height && projection == other.projection;
+}
+
+MapPainterRoute::RouteGeometryKey MapPainterRoute::routeGeometryKey(const PaintContext *context,
+                                                                    const QVector<Line>& lines,
+                                                                    const QStringList& routeTexts) const
+{
+  RouteGeometryKey key;
+  key.centerLon = context->viewport->centerLongitude();
+  key.centerLat = context->viewport->centerLatitude();
+  key.radius = context->viewport->radius();
+  key.width = context->viewport->width();
+  key.height = context->viewport->height();
+  key.projection = static_cast<int>(context->viewport->projection());
+
+  // Route revision is derived from content to catch all kind of edits, procedure and unit changes
+  uint hash = qHash(routeTexts.join(QChar('\n')));
+  for(const Line& line : lines)
+  {
+    hash = 31 * hash + qHash(line.getPos1().getLonX());
+    hash = 31 * hash + qHash(line.getPos1().getLatY());
+    hash = 31 * hash + qHash(line.getPos2().getLonX());
+    hash = 31 * hash + qHash(line.getPos2().getLatY());
+  }
+  key.routeHash = hash;
+  return key;
+}
+
+void MapPainterRoute::projectLines(const PaintContext *context, const QVector<Line>& lines,
+                                   QVector<QVector<QPolygonF> >& polylines) const
+{
+  polylines.clear();
+  polylines.reserve(lines.size());
+
+  GeoDataLineString ls;
+  ls.setTessellate(true);
+  for(const Line& line : lines)
+  {
+    QVector<QPolygonF> legPolylines;
+    if(line.isValid())
+    {
+      ls.clear();
+      ls << GeoDataCoordinates(line.getPos1().getLonX(), line.getPos1().getLatY(), 0, DEG)
+         << GeoDataCoordinates(line.getPos2().getLonX(), line.getPos2().getLatY(), 0, DEG);
+
+      // Same tessellation and projection as used by GeoPainter::drawPolyline
+      QVector<QPolygonF *> polygons;
+      context->viewport->screenCoordinates(ls, polygons);
+      for(QPolygonF *polygon : polygons)
+        legPolylines.append(*polygon);
+      qDeleteAll(polygons);
+    }
+    polylines.append(legPolylines);
+  }
+}
 
+void MapPainterRoute::drawPolylines(QPainter *painter, const QVector<QPolygonF>& polylines) const
+{
+  for(const QPolygonF& polyline : polylines)
+    painter->drawPolyline(polyline);
+}
+
+void MapPainterRoute::clearRouteGeometry()
+{
+  routeGeometryCacheKey = RouteGeometryKey();
+  routeGeometryPolylines.clear();
+  delete routeTextPlacement;
+  routeTextPlacement = nullptr;
 }
 
 void MapPainterRoute::render(PaintContext *context)
@@ -143,6 +218,15 @@ void MapPainterRoute::paintRoute(const PaintContext *context)
       routeTexts.first().clear();
     }
 
+    // Reuse projected lines and text positions if neither route nor view have changed
+    RouteGeometryKey key = routeGeometryKey(context, lines, routeTexts);
+    if(key != routeGeometryCacheKey)
+    {
+      clearRouteGeometry();
+      routeGeometryCacheKey = key;
+      projectLines(context, lines, routeGeometryPolylines);
+    }
+
     const OptionData& od = OptionData::instance();
     QPen routePen(od.getFlightplanColor(), innerlinewidth, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin);
     QPen routeOutlinePen(mapcolors::routeOutlineColor, outerlinewidth, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin);
@@ -152,43 +236,57 @@ void MapPainterRoute::paintRoute(const PaintContext *context)
     // Draw gray line for passed legs
     painter->setPen(routePassedPen);
     for(int i = 0; i < passedRouteLeg; i++)
-      drawLine(context, lines.at(i));
+      drawPolylines(painter, routeGeometryPolylines.at(i));
 
     // Draw background for legs ahead
     painter->setPen(routeOutlinePen);
     for(int i = passedRouteLeg; i < lines.size(); i++)
-      drawLine(context, lines.at(i));
+      drawPolylines(painter, routeGeometryPolylines.at(i));
 
     // Draw center line for legs ahead
     painter->setPen(routePen);
     for(int i = passedRouteLeg; i < lines.size(); i++)
-      drawLine(context, lines.at(i));
+      drawPolylines(painter, routeGeometryPolylines.at(i));
 
     if(activeValid)
     {
       // Draw active leg on top of all others to keep it visible
       painter->setPen(routeOutlinePen);
-      drawLine(context, lines.at(activeRouteLeg - 1));
+      drawPolylines(painter, routeGeometryPolylines.at(activeRouteLeg - 1));
 
       painter->setPen(QPen(OptionData::instance().getFlightplanActiveSegmentColor(), innerlinewidth,
                            Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin));
 
-      drawLine(context, lines.at(activeRouteLeg - 1));
+      drawPolylines(painter, routeGeometryPolylines.at(activeRouteLeg - 1));
     }
   }
 
   context->szFont(context->textSizeFlightplan * 1.1f);
 
-  // Collect coordinates for text placement and lines first
-  LineString positions;
-  for(int i = 0; i < route->size(); i++)
-    positions.append(route->at(i).getPosition());
+  // Text placement depends on route, view, font, line width and fast flag
+  if(lines.isEmpty() || routeTextPlacement == nullptr || routeTextPlacementFast != context->drawFast ||
+     routeTextPlacementFont != painter->font() ||
+     atools::almostNotEqual(routeTextPlacementLineWidth, outerlinewidth))
+  {
+    // Collect coordinates for text placement and lines first
+    LineString positions;
+    for(int i = 0; i < route->size(); i++)
+      positions.append(route->at(i).getPosition());
+
+    delete routeTextPlacement;
+    routeTextPlacement = new TextPlacement(painter, this);
+    routeTextPlacement->setDrawFast(context->drawFast);
+    routeTextPlacement->setLineWidth(outerlinewidth);
+    routeTextPlacement->calculateTextPositions(positions);
+    routeTextPlacement->calculateTextAlongLines(lines, routeTexts);
+    routeTextPlacementFast = context->drawFast;
+    routeTextPlacementFont = painter->font();
+    routeTextPlacementLineWidth = outerlinewidth;
+  }
+  else
+    routeTextPlacement->setPainter(painter);
 
-  TextPlacement textPlacement(painter, this);
-  textPlacement.setDrawFast(context->drawFast);
-  textPlacement.setLineWidth(outerlinewidth);
-  textPlacement.calculateTextPositions(positions);
-  textPlacement.calculateTextAlongLines(lines, routeTexts);
+  TextPlacement& textPlacement = *routeTextPlacement;
   painter->save();
   if(!(context->flags2 & opts::MAP_ROUTE_TEXT_BACKGROUND))
     painter->setBackgroundMode(Qt::TransparentMode);
@@ -22,6 +22,9 @@
 
 #include "geo/line.h"
 
+#include <QFont>
+#include <QPolygonF>
+
 namespace Marble {
 class GeoDataLineString;
 }
@@ -29,6 +32,7 @@ class GeoDataLineString;
 class MapWidget;
 class RouteController;
 class Route;
+class TextPlacement;
 
 namespace proc {
 struct MapProcedureLegs;
@@ -70,6 +74,36 @@ private:
     bool distance, course;
   };
 
+  /* Identifies route content and view for the cached route geometry. Route content is given by a hash of
+   * all leg lines and texts. */
+  struct RouteGeometryKey
+  {
+    uint routeHash = 0;
+    qreal centerLon = 0., centerLat = 0., radius = 0.;
+    int width = 0, height = 0, projection = 0;
+
+    bool operator==(const RouteGeometryKey& other) const;
+    bool operator!=(const RouteGeometryKey& other) const
+    {
+      return !operator==(other);
+    }
+
+  };
+
+  /* Build the cache key for the current view and route lines/texts */
+  RouteGeometryKey routeGeometryKey(const PaintContext *context, const QVector<atools::geo::Line>& lines,
+                                    const QStringList& routeTexts) const;
+
+  /* Project great circle lines into screen polylines like GeoPainter::drawPolyline does */
+  void projectLines(const PaintContext *context, const QVector<atools::geo::Line>& lines,
+                    QVector<QVector<QPolygonF> >& polylines) const;
+
+  /* Draw all projected polylines of a leg */
+  void drawPolylines(QPainter *painter, const QVector<QPolygonF>& polylines) const;
+
+  /* Drop cached route geometry and text placement */
+  void clearRouteGeometry();
+
   void paintRoute(const PaintContext *context);
 
   void paintAirport(const PaintContext *context, int x, int y, const map::MapAirport& obj);
@@ -117,6 +151,14 @@ private:
   void drawStartParking(const PaintContext *context);
 
   const Route *route;
+
+  /* Projected route leg lines and text placement cached until route or view change */
+  RouteGeometryKey routeGeometryCacheKey;
+  QVector<QVector<QPolygonF> > routeGeometryPolylines;
+  TextPlacement *routeTextPlacement = nullptr;
+  bool routeTextPlacementFast = false;
+  QFont routeTextPlacementFont;
+  float routeTextPlacementLineWidth = 0.f;
 };
 
 #endif // LITTLENAVMAP_MAPPAINTERROUTE_H
@@ -45,6 +45,12 @@ using map::MapAirway;
 using Marble::GeoDataLineString;
 using Marble::GeoDataCoordinates;
 
+/* Maximum distance in pixel between projected great circle and straight screen line for airway hover lines */
+static const int AIRWAY_SUBDIVIDE_TOLERANCE = 3;
+
+/* Split airway segments into 2^depth lines at most */
+static const int AIRWAY_SUBDIVIDE_MAX_DEPTH = 6;
+
 MapScreenIndex::MapScreenIndex(MapWidget *parentWidget, MapPaintLayer *mapPaintLayer)
   : mapWidget(parentWidget), paintLayer(mapPaintLayer)
 {
@@ -154,6 +160,9 @@ void MapScreenIndex::updateAirwayScreenGeometry(const Marble::GeoDataLatLonAltBo
     const QList<MapAirway> *airways = mapQuery->getAirways(curBox, paintLayer->getMapLayer(), false);
     const QRect& mapGeo = mapWidget->rect();
 
+    // Screen coordinates of waypoints by id - consecutive segments and crossing airways share endpoints
+    QHash<int, QPoint> waypointPoints;
+
     for(int i = 0; i < airways->size(); i++)
     {
       const MapAirway& airway = airways->at(i);
@@ -167,32 +176,61 @@ void MapScreenIndex::updateAirwayScreenGeometry(const Marble::GeoDataLatLonAltBo
       if(airwaybox.intersects(curBox))
       {
         // Airway segment intersects with view rectangle
-        float distanceMeter = airway.from.distanceMeterTo(airway.to);
-        // Approximate the needed number of line segments
-        float numSegments = std::min(std::max(scale->getPixelIntForMeter(distanceMeter) / 40.f, 2.f), 72.f);
-        float step = 1.f / numSegments;
+        QPoint from = airwayWaypointToScreen(waypointPoints, airway.fromWaypointId, airway.from, conv);
+        QPoint to = airwayWaypointToScreen(waypointPoints, airway.toWaypointId, airway.to, conv);
 
-        // Split the segments into smaller lines and add them only if visible
-        for(int j = 0; j < numSegments; j++)
-        {
-          float cur = step * static_cast<float>(j);
-          int xs1, ys1, xs2, ys2;
-          conv.wToS(airway.from.interpolate(airway.to, distanceMeter, cur), xs1, ys1);
-          conv.wToS(airway.from.interpolate(airway.to, distanceMeter, cur + step), xs2, ys2);
-
-          QRect rect(QPoint(xs1, ys1), QPoint(xs2, ys2));
-          rect = rect.normalized();
-          // Avoid points or flat rectangles (lines)
-          rect.adjust(-1, -1, 1, 1);
-
-          if(mapGeo.intersects(rect))
-            airwayLines.append(std::make_pair(airway.id, QLine(xs1, ys1, xs2, ys2)));
-        }
+        // Split the segment only where the great circle deviates from the straight screen line
+        addAirwayScreenLines(airway, airway.from.distanceMeterTo(airway.to), 0.f, from, 1.f, to, 0, conv, mapGeo);
       }
     }
   }
 }
 
+QPoint MapScreenIndex::airwayWaypointToScreen(QHash<int, QPoint>& waypointPoints, int waypointId,
+                                              const Pos& pos, const CoordinateConverter& conv)
+{
+  QHash<int, QPoint>::const_iterator it = waypointPoints.constFind(waypointId);
+  if(it != waypointPoints.constEnd())
+    return it.value();
+
+  int x, y;
+  conv.wToS(pos, x, y);
+  QPoint point(x, y);
+  waypointPoints.insert(waypointId, point);
+  return point;
+}
+
+void MapScreenIndex::addAirwayScreenLines(const map::MapAirway& airway, float distanceMeter,
+                                          float fraction1, const QPoint& point1,
+                                          float fraction2, const QPoint& point2,
+                                          int depth, const CoordinateConverter& conv, const QRect& mapGeo)
+{
+  if(depth < AIRWAY_SUBDIVIDE_MAX_DEPTH && (point2 - point1).manhattanLength() > AIRWAY_SUBDIVIDE_TOLERANCE)
+  {
+    // Compare projected great circle center with center of the screen line
+    float fractionMid = (fraction1 + fraction2) / 2.f;
+    int xm, ym;
+    conv.wToS(airway.from.interpolate(airway.to, distanceMeter, fractionMid), xm, ym);
+    QPoint mid(xm, ym);
+
+    if((mid - (point1 + point2) / 2).manhattanLength() > AIRWAY_SUBDIVIDE_TOLERANCE)
+    {
+      addAirwayScreenLines(airway, distanceMeter, fraction1, point1, fractionMid, mid, depth + 1, conv, mapGeo);
+      addAirwayScreenLines(airway, distanceMeter, fractionMid, mid, fraction2, point2, depth + 1, conv, mapGeo);
+      return;
+    }
+  }
+
+  QRect rect(point1, point2);
+  rect = rect.normalized();
+  // Avoid points or flat rectangles (lines)
+  rect.adjust(-1, -1, 1, 1);
+
+  // Add line only if visible
+  if(mapGeo.intersects(rect))
+    airwayLines.append(std::make_pair(airway.id, QLine(point1, point2)));
+}
+
 void MapScreenIndex::saveState()
 {
   atools::settings::Settings& s = atools::settings::Settings::instance();
@@ -302,6 +340,9 @@ void MapScreenIndex::updateRouteScreenGeometry(const Marble::GeoDataLatLonAltBox
 void MapScreenIndex::getAllNearest(int xs, int ys, int maxDistance, map::MapSearchResult& result,
                                    QList<proc::MapProcedurePoint>& procPoints)
 {
+  // Index might be outdated if the view was changed just before
+  mapWidget->updateScreenIndexPending();
+
   using maptools::insertSortedByDistance;
 
   CoordinateConverter conv(mapWidget->viewport());
@@ -486,6 +527,9 @@ int MapScreenIndex::getNearestIndex(int xs, int ys, int maxDistance, const QList
 
 int MapScreenIndex::getNearestRoutePointIndex(int xs, int ys, int maxDistance)
 {
+  // Index might be outdated if the view was changed just before
+  mapWidget->updateScreenIndexPending();
+
   if(!paintLayer->getShownMapObjects().testFlag(map::FLIGHTPLAN))
     return -1;
 
@@ -563,6 +607,9 @@ void MapScreenIndex::getNearestAirways(int xs, int ys, int maxDistance, map::Map
 
 int MapScreenIndex::getNearestRouteLegIndex(int xs, int ys, int maxDistance)
 {
+  // Index might be outdated if the view was changed just before
+  mapWidget->updateScreenIndexPending();
+
   if(!paintLayer->getShownMapObjects().testFlag(map::FLIGHTPLAN))
     return -1;
 
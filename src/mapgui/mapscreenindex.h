@@ -22,8 +22,11 @@
 
 #include "route/route.h"
 
+#include <QHash>
+
 namespace map {
 struct MapSearchResult;
+struct MapAirway;
 
 }
 
@@ -32,6 +35,7 @@ class GeoDataLatLonAltBox;
 }
 
 class MapWidget;
+class CoordinateConverter;
 class AirportQuery;
 class AirspaceQuery;
 class MapPaintLayer;
@@ -203,6 +207,16 @@ private:
   void updateAirspaceScreenGeometry(QList<std::pair<int, QPolygon> >& polygons, AirspaceQuery *query,
                                     const Marble::GeoDataLatLonAltBox& curBox);
 
+  /* Get screen coordinates for waypoint from hash or calculate and insert them */
+  static QPoint airwayWaypointToScreen(QHash<int, QPoint>& waypointPoints, int waypointId,
+                                       const atools::geo::Pos& pos, const CoordinateConverter& conv);
+
+  /* Add hover lines for the airway segment part between fraction1 and fraction2. Subdivides recursively
+   * as long as the projected great circle deviates more than a tolerance from the screen line. */
+  void addAirwayScreenLines(const map::MapAirway& airway, float distanceMeter,
+                            float fraction1, const QPoint& point1, float fraction2, const QPoint& point2,
+                            int depth, const CoordinateConverter& conv, const QRect& mapGeo);
+
   template<typename TYPE>
   int getNearestIndex(int xs, int ys, int maxDistance, const QList<TYPE>& typeList);
 
@@ -37,6 +37,7 @@
 #include "atools.h"
 #include "query/mapquery.h"
 #include "query/airportquery.h"
+#include "mapgui/aprongeometrycache.h"
 #include "mapgui/maptooltip.h"
 #include "common/symbolpainter.h"
 #include "mapgui/mapscreenindex.h"
@@ -68,9 +69,15 @@ const int DEFAULT_MAP_DISTANCE = 7000;
 // Get elevation when mouse is still
 const int ALTITUDE_UPDATE_TIMEOUT = 200;
 
+/* Delay screen index update after view changes to let the frame show first */
+const int SCREEN_INDEX_UPDATE_TIMEOUT = 50;
+
 // Delay recognition to avoid detection of bumps
 const int TAKEOFF_LANDING_TIMEOUT = 5000;
 
+/* Delay building of apron geometry to let flight plan editing finish first */
+const int APRON_PREWARM_TIMEOUT = 1000;
+
 /* If width and height of a bounding rect are smaller than this use show point */
 const float POS_IS_POINT_EPSILON = 0.0001f;
 
@@ -158,20 +165,30 @@ MapWidget::MapWidget(MainWindow *parent)
   elevationDisplayTimer.setSingleShot(true);
   connect(&elevationDisplayTimer, &QTimer::timeout, this, &MapWidget::elevationDisplayTimerTimeout);
 
+  screenIndexUpdateTimer.setInterval(SCREEN_INDEX_UPDATE_TIMEOUT);
+  screenIndexUpdateTimer.setSingleShot(true);
+  connect(&screenIndexUpdateTimer, &QTimer::timeout, this, &MapWidget::screenIndexUpdateTimeout);
+
   jumpBackToAircraftTimer.setSingleShot(true);
   connect(&jumpBackToAircraftTimer, &QTimer::timeout, this, &MapWidget::jumpBackToAircraftTimeout);
 
   takeoffLandingTimer.setSingleShot(true);
   connect(&takeoffLandingTimer, &QTimer::timeout, this, &MapWidget::takeoffLandingTimeout);
 
+  apronPreWarmTimer.setInterval(APRON_PREWARM_TIMEOUT);
+  apronPreWarmTimer.setSingleShot(true);
+  connect(&apronPreWarmTimer, &QTimer::timeout, this, &MapWidget::preWarmApronGeometry);
+
   mapVisible = new MapVisible(paintLayer);
 }
 
 MapWidget::~MapWidget()
 {
   elevationDisplayTimer.stop();
+  screenIndexUpdateTimer.stop();
   jumpBackToAircraftTimer.stop();
   takeoffLandingTimer.stop();
+  apronPreWarmTimer.stop();
 
   qDebug() << Q_FUNC_INFO << "removeEventFilter";
   removeEventFilter(this);
@@ -494,6 +511,10 @@ void MapWidget::preDatabaseLoad()
   cancelDragAll();
   databaseLoadStatus = true;
   paintLayer->preDatabaseLoad();
+
+  // Cache is invalid for the new database - build again for the same airports after loading
+  apronPreWarmTimer.stop();
+  apronPreWarmAirportIds.clear();
 }
 
 void MapWidget::postDatabaseLoad()
@@ -503,6 +524,7 @@ void MapWidget::postDatabaseLoad()
   screenIndex->updateAirwayScreenGeometry(currentViewBoundingBox);
   screenIndex->updateAirspaceScreenGeometry(currentViewBoundingBox);
   screenIndex->updateRouteScreenGeometry(currentViewBoundingBox);
+  updateApronPreWarm();
   update();
   mapVisible->updateVisibleObjectsStatusBar();
 }
@@ -1122,10 +1144,43 @@ void MapWidget::routeChanged(bool geometryChanged)
   {
     cancelDragAll();
     screenIndex->updateRouteScreenGeometry(currentViewBoundingBox);
+    updateApronPreWarm();
     update();
   }
 }
 
+void MapWidget::updateApronPreWarm()
+{
+  const Route& route = NavApp::getRouteConst();
+  QVector<int> airportIds;
+  airportIds.append(route.hasValidDeparture() ? route.first().getAirport().id : -1);
+  airportIds.append(route.hasValidDestination() ? route.last().getAirport().id : -1);
+
+  if(airportIds != apronPreWarmAirportIds)
+  {
+    // Departure or destination changed - restart timer which drops a pending update
+    apronPreWarmAirportIds = airportIds;
+    apronPreWarmTimer.start();
+  }
+}
+
+void MapWidget::preWarmApronGeometry()
+{
+  if(NavApp::isLoadingDatabase() || databaseLoadStatus)
+    return;
+
+  // Build X-Plane apron geometry for the departure and destination airport diagrams
+  const Route& route = NavApp::getRouteConst();
+  AirportQuery *airportQuery = NavApp::getAirportQuerySim();
+  ApronGeometryCache *cache = NavApp::getApronGeometryCache();
+
+  if(route.hasValidDeparture())
+    cache->preWarm(*airportQuery->getAprons(route.first().getAirport().id));
+
+  if(route.hasValidDestination())
+    cache->preWarm(*airportQuery->getAprons(route.last().getAirport().id));
+}
+
 void MapWidget::routeAltitudeChanged(float altitudeFeet)
 {
   Q_UNUSED(altitudeFeet);
@@ -1237,8 +1292,22 @@ void MapWidget::simDataChanged(const atools::fs::sc::SimConnectData& simulatorDa
   if(now - lastSimUpdateTooltipMs > MAX_SIM_UPDATE_TOOLTIP_MS)
   {
     lastSimUpdateTooltipMs = now;
+
+    // Refresh AI aircraft shown in tooltip from the object id index of the last packet
+    bool aiUpdated = false;
+    for(atools::fs::sc::SimConnectAircraft& ai : mapSearchResultTooltip.aiAircraft)
+    {
+      const atools::fs::sc::SimConnectAircraft *newAi =
+        NavApp::getConnectClient()->getAiAircraftById(ai.getObjectId());
+      if(newAi != nullptr)
+      {
+        ai = *newAi;
+        aiUpdated = true;
+      }
+    }
+
     if((mapSearchResultTooltip.hasAirports() || mapSearchResultTooltip.hasVor() || mapSearchResultTooltip.hasNdb() ||
-        mapSearchResultTooltip.hasWaypoints() || mapSearchResultTooltip.hasUserpoints()) &&
+        mapSearchResultTooltip.hasWaypoints() || mapSearchResultTooltip.hasUserpoints() || aiUpdated) &&
        NavApp::isConnectedAndAircraft())
     {
       updateTooltip();
@@ -3429,18 +3498,34 @@ void MapWidget::paintEvent(QPaintEvent *paintEvent)
   MarbleWidget::paintEvent(paintEvent);
 
   if(changed)
-  {
-    // Major change - update index and visible objects
-    mapVisible->updateVisibleObjectsStatusBar();
-    screenIndex->updateRouteScreenGeometry(currentViewBoundingBox);
-    screenIndex->updateAirwayScreenGeometry(currentViewBoundingBox);
-    screenIndex->updateAirspaceScreenGeometry(currentViewBoundingBox);
-  }
+    // Major change - update index and visible objects after the frame is shown
+    // Restarting cancels an update for a previous view change
+    screenIndexUpdateTimer.start();
 
   if(paintLayer->getOverflow() > 0)
     emit resultTruncated(paintLayer->getOverflow());
 }
 
+void MapWidget::screenIndexUpdateTimeout()
+{
+  if(!active)
+    return;
+
+  mapVisible->updateVisibleObjectsStatusBar();
+  screenIndex->updateRouteScreenGeometry(currentViewBoundingBox);
+  screenIndex->updateAirwayScreenGeometry(currentViewBoundingBox);
+  screenIndex->updateAirspaceScreenGeometry(currentViewBoundingBox);
+}
+
+void MapWidget::updateScreenIndexPending()
+{
+  if(screenIndexUpdateTimer.isActive())
+  {
+    screenIndexUpdateTimer.stop();
+    screenIndexUpdateTimeout();
+  }
+}
+
 void MapWidget::handleInfoClick(QPoint pos)
 {
   qDebug() << Q_FUNC_INFO;
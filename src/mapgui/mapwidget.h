@@ -261,6 +261,10 @@ public:
   /* Update the shown map object types depending on action status (toolbar or menu) */
   void updateMapObjectsShown();
 
+  /* Run a screen index update scheduled by a view change now if it is still pending.
+   * Called before hit-testing so that the index matches the shown map. */
+  void updateScreenIndexPending();
+
   /* Update tooltip in case of weather changes */
   void showTooltip(bool update);
   void updateTooltip();
@@ -400,6 +404,15 @@ private:
   void cancelDragDistance();
   void cancelDragRoute();
   void elevationDisplayTimerTimeout();
+
+  /* Update screen index and visible objects after a view change */
+  void screenIndexUpdateTimeout();
+
+  /* Fill apron geometry cache for departure and destination airports of the flight plan. Called by timer. */
+  void preWarmApronGeometry();
+
+  /* Start delayed pre-warming of the apron geometry cache if departure or destination changed */
+  void updateApronPreWarm();
   void cancelDragUserpoint();
 
   void jumpBackToAircraftTimeout();
@@ -493,9 +506,19 @@ private:
   /* Delay display of elevation display to avoid lagging mouse movements */
   QTimer elevationDisplayTimer;
 
+  /* Rebuild screen index after the frame is shown. Restarted on each view change which drops
+   * the update for the previous view. */
+  QTimer screenIndexUpdateTimer;
+
   /* Delay takeoff and landing messages to avoid false recognition of bumpy landings */
   QTimer takeoffLandingTimer;
 
+  /* Delay building of apron geometry after flight plan changes */
+  QTimer apronPreWarmTimer;
+
+  /* Departure and destination airport ids for which the apron geometry cache was filled. -1 if not valid. */
+  QVector<int> apronPreWarmAirportIds;
+
   /* Simulator zulu time timestamp of takeoff event */
   qint64 takeoffTimeMs = 0L;
 
@@ -40,6 +40,8 @@
 #include "gui/stylehandler.h"
 #include "weather/weatherreporter.h"
 #include "fs/weather/metar.h"
+#include "db/databasepool.h"
+#include "sql/sqldatabase.h"
 
 #include "ui_mainwindow.h"
 
@@ -47,6 +49,10 @@
 
 #include <QIcon>
 #include <QSplashScreen>
+#include <QElapsedTimer>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <exception>
 
 AirportQuery *NavApp::airportQuerySim = nullptr;
 AirportQuery *NavApp::airportQueryNav = nullptr;
@@ -96,36 +102,90 @@ NavApp *NavApp::navAppInstance()
   return dynamic_cast<NavApp *>(QCoreApplication::instance());
 }
 
+/* Result of a startup step running in a worker thread */
+struct StartupTaskResult
+{
+  QString name;
+  qint64 elapsedMs = 0;
+  bool done = false; /* false if no pooled connection was available and the step has to be repeated */
+  std::exception_ptr exception;
+};
+
+/* Runs a table reader with a pooled connection of the calling worker thread */
+template<typename READER>
+static StartupTaskResult runStartupTask(const QString& name, DatabasePool *pool, dbpool::DatabaseType type,
+                                        READER *reader)
+{
+  StartupTaskResult result;
+  result.name = name;
+  QElapsedTimer timer;
+  timer.start();
+
+  try
+  {
+    atools::sql::SqlDatabase *db = pool->getDatabase(type);
+    if(db != nullptr)
+    {
+      reader->readFromTable(*db);
+      result.done = true;
+    }
+  }
+  catch(...)
+  {
+    result.exception = std::current_exception();
+  }
+
+  // Close the connection of this pool thread - it is not needed anymore
+  pool->releaseThread();
+
+  result.elapsedMs = timer.elapsed();
+  return result;
+}
+
 void NavApp::init(MainWindow *mainWindowParam)
 {
   qDebug() << Q_FUNC_INFO;
 
+  /* Step name and elapsed time in ms for the startup report */
+  QVector<std::pair<QString, qint64> > timing;
+  QElapsedTimer totalTimer, timer;
+  totalTimer.start();
+  timer.start();
+
   NavApp::mainWindow = mainWindowParam;
   databaseManager = new DatabaseManager(mainWindow);
   databaseManager->openAllDatabases();
-  userdataController = new UserdataController(databaseManager->getUserdataManager(), mainWindow);
-
-  databaseMeta = new atools::fs::db::DatabaseMeta(getDatabaseSim());
-  databaseMetaNav = new atools::fs::db::DatabaseMeta(getDatabaseNav());
+  timing.append(std::make_pair(QString("Open databases"), timer.restart()));
 
+  // Read magnetic declination and MORA grid in worker threads using pooled connections
+  // while the query objects are set up in the GUI thread
+  DatabasePool *pool = databaseManager->getDatabasePool();
   magDecReader = new atools::fs::common::MagDecReader();
-  magDecReader->readFromTable(*databaseManager->getDatabaseSim());
+  QFuture<StartupTaskResult> magDecFuture =
+    QtConcurrent::run(runStartupTask<atools::fs::common::MagDecReader>, QString("Magnetic declination"), pool,
+                      dbpool::SIM, magDecReader);
 
   moraReader = new atools::fs::common::MoraReader(databaseManager->getDatabaseNav());
-  moraReader->readFromTable();
+  QFuture<StartupTaskResult> moraFuture =
+    QtConcurrent::run(runStartupTask<atools::fs::common::MoraReader>, QString("MORA grid"), pool,
+                      dbpool::NAV, moraReader);
 
-  vehicleIcons = new VehicleIcons();
+  userdataController = new UserdataController(databaseManager->getUserdataManager(), mainWindow);
 
-  // Need to set this later to avoid circular database dependency
-  userdataController->setMagDecReader(magDecReader);
+  databaseMeta = new atools::fs::db::DatabaseMeta(getDatabaseSim());
+  databaseMetaNav = new atools::fs::db::DatabaseMeta(getDatabaseNav());
+
+  vehicleIcons = new VehicleIcons();
 
   // Create a CSV backup - not needed since the database is backed up now
   // userdataController->backup();
   // Clear temporary userpoints
   userdataController->clearTemporary();
+  timing.append(std::make_pair(QString("Userdata"), timer.restart()));
 
   onlinedataController = new OnlinedataController(databaseManager->getOnlinedataManager(), mainWindow);
   onlinedataController->initQueries();
+  timing.append(std::make_pair(QString("Online data"), timer.restart()));
 
   mapQuery = new MapQuery(mainWindow, databaseManager->getDatabaseSim(), databaseManager->getDatabaseNav(),
                           databaseManager->getDatabaseUser());
@@ -148,6 +208,7 @@ void NavApp::init(MainWindow *mainWindowParam)
 
   procedureQuery = new ProcedureQuery(databaseManager->getDatabaseNav());
   procedureQuery->initQueries();
+  timing.append(std::make_pair(QString("Queries"), timer.restart()));
 
   apronGeometryCache = new ApronGeometryCache();
 
@@ -156,6 +217,36 @@ void NavApp::init(MainWindow *mainWindowParam)
   updateHandler = new UpdateHandler(mainWindow);
 
   styleHandler = new StyleHandler();
+  timing.append(std::make_pair(QString("Handlers"), timer.restart()));
+
+  // Join all worker steps before looking at the results - waiting time is reported separately from
+  // the time spent in the worker
+  StartupTaskResult magDecResult = magDecFuture.result();
+  StartupTaskResult moraResult = moraFuture.result();
+
+  // Rethrow the first exception only after all workers are finished
+  for(const StartupTaskResult& result : {magDecResult, moraResult})
+  {
+    timing.append(std::make_pair(result.name + " (worker)", result.elapsedMs));
+
+    if(result.exception)
+      std::rethrow_exception(result.exception);
+  }
+
+  if(!magDecResult.done)
+    // No pooled connection - read in GUI thread
+    magDecReader->readFromTable(*databaseManager->getDatabaseSim());
+
+  if(!moraResult.done)
+    moraReader->readFromTable();
+  timing.append(std::make_pair(QString("Wait for workers"), timer.restart()));
+
+  // Need to set this later to avoid circular database dependency
+  userdataController->setMagDecReader(magDecReader);
+
+  qInfo() << Q_FUNC_INFO << "Startup timing total" << totalTimer.elapsed() << "ms";
+  for(const std::pair<QString, qint64>& step : timing)
+    qInfo() << Q_FUNC_INFO << "Startup timing" << step.first << step.second << "ms";
 
   // The check will be called on main window shown
 }
@@ -456,6 +547,11 @@ atools::sql::SqlDatabase *NavApp::getDatabaseNav()
   return getDatabaseManager()->getDatabaseNav();
 }
 
+DatabasePool *NavApp::getDatabasePool()
+{
+  return getDatabaseManager()->getDatabasePool();
+}
+
 atools::fs::userdata::UserdataManager *NavApp::getUserdataManager()
 {
   return databaseManager->getUserdataManager();
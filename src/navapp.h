@@ -32,6 +32,7 @@ class Route;
 class MainWindow;
 class ConnectClient;
 class DatabaseManager;
+class DatabasePool;
 class QMainWindow;
 class RouteController;
 class MapWidget;
@@ -173,6 +174,9 @@ public:
   /* External update from navaids or same as above */
   static atools::sql::SqlDatabase *getDatabaseNav();
 
+  /* Read-only simulator and navdata connections for worker threads */
+  static DatabasePool *getDatabasePool();
+
   static atools::fs::userdata::UserdataManager *getUserdataManager();
   static UserdataIcons *getUserdataIcons();
   static UserdataSearch *getUserdataSearch();
@@ -235,6 +235,9 @@ void ProfileWidget::updateScreenCoords()
 {
   /* Update all screen coordinates and scale factors */
 
+  // Static parts have to be drawn again
+  staticLayerValid = false;
+
   MapWidget *mapWidget = NavApp::getMapWidget();
   // Widget drawing region width and height
   int w = rect().width() - X0 * 2, h = rect().height() - Y0;
@@ -276,14 +279,36 @@ void ProfileWidget::updateScreenCoords()
   {
     waypointX.append(X0 + static_cast<int>(leg.distances.first() * horizontalScale));
 
+    // Use the coarsest decimation level which still has at least one point per pixel
+    float legPixel = (leg.distances.last() - leg.distances.first()) * horizontalScale;
+    const ElevationLevel *level = nullptr;
+    for(const ElevationLevel& lvl : leg.levels)
+    {
+      if(lvl.distances.size() >= legPixel)
+        level = &lvl;
+      else
+        break;
+    }
+
+    int numPoints = level != nullptr ? level->distances.size() : leg.elevation.size();
     QPoint lastPt;
-    for(int i = 0; i < leg.elevation.size(); i++)
+    for(int i = 0; i < numPoints; i++)
     {
-      float alt = leg.elevation.at(i).getAltitude();
-      QPoint pt(X0 + static_cast<int>(leg.distances.at(i) * horizontalScale),
-                Y0 + static_cast<int>(h - alt *verticalScale));
+      float alt, dist;
+      if(level != nullptr)
+      {
+        alt = level->maxElevations.at(i);
+        dist = level->distances.at(i);
+      }
+      else
+      {
+        alt = leg.elevation.at(i).getAltitude();
+        dist = leg.distances.at(i);
+      }
+
+      QPoint pt(X0 + static_cast<int>(dist * horizontalScale), Y0 + static_cast<int>(h - alt * verticalScale));
 
-      if(lastPt.isNull() || i == leg.elevation.size() - 1 || (lastPt - pt).manhattanLength() > 2)
+      if(lastPt.isNull() || i == numPoints - 1 || (lastPt - pt).manhattanLength() > 2)
       {
         landPolygon.append(pt);
         lastPt = pt;
@@ -327,18 +352,121 @@ void ProfileWidget::paintEvent(QPaintEvent *)
 
   QPainter painter(this);
   painter.setRenderHint(QPainter::Antialiasing);
-  painter.fillRect(rect(), darkStyle ? mapcolors::profileBackgroundDarkColor : mapcolors::profileBackgroundColor);
-  painter.fillRect(X0, 0, w, h + Y0, darkStyle ? mapcolors::profileSkyDarkColor : mapcolors::profileSkyColor);
-
-  SymbolPainter symPainter;
 
   if(!widgetVisible || legList.elevationLegs.isEmpty() || legList.route.isEmpty())
   {
+    painter.fillRect(rect(), darkStyle ? mapcolors::profileBackgroundDarkColor : mapcolors::profileBackgroundColor);
+    painter.fillRect(X0, 0, w, h + Y0, darkStyle ? mapcolors::profileSkyDarkColor : mapcolors::profileSkyColor);
+
+    SymbolPainter symPainter;
     symPainter.textBox(&painter, {tr("No Flight Plan")}, QPen(Qt::black),
                        X0 + w / 4, Y0 + h / 2, textatt::BOLD, 255);
     return;
   }
 
+  // Terrain, scale, route and symbols change only with route, elevation, size or options
+  qreal pixelRatio = devicePixelRatioF();
+  QSize pixmapSize = size() * pixelRatio;
+  if(!staticLayerValid || staticLayer.size() != pixmapSize || staticLayerDarkStyle != darkStyle)
+  {
+    staticLayer = QPixmap(pixmapSize);
+    staticLayer.setDevicePixelRatio(pixelRatio);
+
+    QPainter staticPainter(&staticLayer);
+    staticPainter.setFont(font());
+    staticPainter.setRenderHint(QPainter::Antialiasing);
+    paintStaticLayer(staticPainter, darkStyle);
+
+    staticLayerValid = true;
+    staticLayerDarkStyle = darkStyle;
+  }
+  painter.drawPixmap(0, 0, staticLayer);
+
+  // Draw dynamic parts on top of the cached layer ===================================
+  SymbolPainter symPainter;
+  QFont font = painter.font();
+  float defaultFontSize = static_cast<float>(font.pointSizeF());
+  font.setBold(true);
+
+  if(!NavApp::getRouteConst().isFlightplanEmpty())
+  {
+    // Draw user aircraft track
+    if(!aircraftTrackPoints.isEmpty() && showAircraftTrack &&
+       aircraftTrackPoints.boundingRect().width() > MIN_AIRCRAFT_TRACK_WIDTH)
+    {
+      painter.setPen(mapcolors::aircraftTrailPen(2.f));
+      painter.drawPolyline(aircraftTrackPoints);
+    }
+
+    // Draw user aircraft
+    if(simData.getUserAircraftConst().getPosition().isValid() && showAircraft)
+    {
+      float acx = X0 + aircraftDistanceFromStart * horizontalScale;
+      float acy = Y0 + (h - simData.getUserAircraftConst().getPosition().getAltitude() * verticalScale);
+
+      // Draw aircraft symbol
+      painter.translate(acx, acy);
+      painter.rotate(90);
+      symPainter.drawAircraftSymbol(&painter, 0, 0, 16, simData.getUserAircraftConst().isOnGround());
+      painter.resetTransform();
+
+      // Draw aircraft label
+      font.setPointSizeF(defaultFontSize);
+      painter.setFont(font);
+
+      int vspeed = atools::roundToInt(simData.getUserAircraftConst().getVerticalSpeedFeetPerMin());
+      QString upDown;
+      if(vspeed > 100.f)
+        upDown = tr(" ▲");
+      else if(vspeed < -100.f)
+        upDown = tr(" ▼");
+
+      QStringList texts;
+      texts.append(Unit::altFeet(simData.getUserAircraftConst().getPosition().getAltitude()));
+
+      if(vspeed > 10.f || vspeed < -10.f)
+        texts.append(Unit::speedVertFpm(vspeed) + upDown);
+
+      // texts.append(Unit::distNm(aircraftDistanceFromStart) + tr(" ► ") +
+      // Unit::distNm(aircraftDistanceToDest));
+
+      textatt::TextAttributes att = textatt::BOLD;
+      float textx = acx, texty = acy + 20.f;
+
+      QRect rect = symPainter.textBoxSize(&painter, texts, att);
+      if(textx + rect.right() > X0 + w)
+        // Move text to the left when approaching the right corner
+        att |= textatt::RIGHT;
+
+      att |= textatt::ROUTE_BG_COLOR;
+
+      if(texty + rect.bottom() > Y0 + h)
+        // Move text down when approaching top boundary
+        texty -= rect.bottom() + 20.f;
+
+      symPainter.textBoxF(&painter, texts, QPen(Qt::black), textx, texty, att, 255);
+    }
+  }
+
+  // Dim the whole map
+  if(NavApp::isCurrentGuiStyleNight())
+  {
+    int dim = OptionData::instance().getGuiStyleMapDimming();
+    QColor col = QColor::fromRgb(0, 0, 0, 255 - (255 * dim / 100));
+    painter.fillRect(QRect(0, 0, width(), height()), col);
+  }
+
+}
+
+void ProfileWidget::paintStaticLayer(QPainter& painter, bool darkStyle)
+{
+  int w = rect().width() - X0 * 2, h = rect().height() - Y0;
+
+  painter.fillRect(rect(), darkStyle ? mapcolors::profileBackgroundDarkColor : mapcolors::profileBackgroundColor);
+  painter.fillRect(X0, 0, w, h + Y0, darkStyle ? mapcolors::profileSkyDarkColor : mapcolors::profileSkyColor);
+
+  SymbolPainter symPainter;
+
   // Draw the mountains
   painter.setBrush(darkStyle ? mapcolors::profileLandDarkColor : mapcolors::profileLandColor);
   painter.setPen(darkStyle ? mapcolors::profileLandOutlineDarkPen : mapcolors::profileLandOutlinePen);
@@ -589,73 +717,7 @@ void ProfileWidget::paintEvent(QPaintEvent *)
                          todX + 8, flightplanY + 8,
                          textatt::ROUTE_BG_COLOR | textatt::BOLD, 255);
     }
-
-    // Draw user aircraft track
-    if(!aircraftTrackPoints.isEmpty() && showAircraftTrack &&
-       aircraftTrackPoints.boundingRect().width() > MIN_AIRCRAFT_TRACK_WIDTH)
-    {
-      painter.setPen(mapcolors::aircraftTrailPen(2.f));
-      painter.drawPolyline(aircraftTrackPoints);
-    }
-
-    // Draw user aircraft
-    if(simData.getUserAircraftConst().getPosition().isValid() && showAircraft)
-    {
-      float acx = X0 + aircraftDistanceFromStart * horizontalScale;
-      float acy = Y0 + (h - simData.getUserAircraftConst().getPosition().getAltitude() * verticalScale);
-
-      // Draw aircraft symbol
-      painter.translate(acx, acy);
-      painter.rotate(90);
-      symPainter.drawAircraftSymbol(&painter, 0, 0, 16, simData.getUserAircraftConst().isOnGround());
-      painter.resetTransform();
-
-      // Draw aircraft label
-      font.setPointSizeF(defaultFontSize);
-      painter.setFont(font);
-
-      int vspeed = atools::roundToInt(simData.getUserAircraftConst().getVerticalSpeedFeetPerMin());
-      QString upDown;
-      if(vspeed > 100.f)
-        upDown = tr(" ▲");
-      else if(vspeed < -100.f)
-        upDown = tr(" ▼");
-
-      QStringList texts;
-      texts.append(Unit::altFeet(simData.getUserAircraftConst().getPosition().getAltitude()));
-
-      if(vspeed > 10.f || vspeed < -10.f)
-        texts.append(Unit::speedVertFpm(vspeed) + upDown);
-
-      // texts.append(Unit::distNm(aircraftDistanceFromStart) + tr(" ► ") +
-      // Unit::distNm(aircraftDistanceToDest));
-
-      textatt::TextAttributes att = textatt::BOLD;
-      float textx = acx, texty = acy + 20.f;
-
-      QRect rect = symPainter.textBoxSize(&painter, texts, att);
-      if(textx + rect.right() > X0 + w)
-        // Move text to the left when approaching the right corner
-        att |= textatt::RIGHT;
-
-      att |= textatt::ROUTE_BG_COLOR;
-
-      if(texty + rect.bottom() > Y0 + h)
-        // Move text down when approaching top boundary
-        texty -= rect.bottom() + 20.f;
-
-      symPainter.textBoxF(&painter, texts, QPen(Qt::black), textx, texty, att, 255);
-    }
   }
-
-  // Dim the whole map
-  if(NavApp::isCurrentGuiStyleNight())
-  {
-    int dim = OptionData::instance().getGuiStyleMapDimming();
-    QColor col = QColor::fromRgb(0, 0, 0, 255 - (255 * dim / 100));
-    painter.fillRect(QRect(0, 0, width(), height()), col);
-  }
-
 }
 
 /* Update signal from Marble elevation model */
@@ -883,12 +945,51 @@ ProfileWidget::ElevationLegList ProfileWidget::fetchRouteElevationsThread(Elevat
       leg.elevation.append(lastLeg.getPosition());
       leg.elevation.append(routeLeg.getPosition());
     }
+
+    buildElevationLevels(leg);
     legs.elevationLegs.append(leg);
   }
 
   return legs;
 }
 
+void ProfileWidget::buildElevationLevels(ElevationLeg& leg) const
+{
+  leg.levels.clear();
+
+  // Start with full resolution
+  QVector<float> distances = leg.distances;
+  QVector<float> elevations;
+  elevations.reserve(leg.elevation.size());
+  for(const Pos& pos : leg.elevation)
+    elevations.append(pos.getAltitude());
+
+  while(distances.size() > MIN_ELEVATION_LEVEL_POINTS)
+  {
+    // Merge each pair of points of the previous level
+    ElevationLevel level;
+    level.distances.reserve(distances.size() / 2 + 2);
+    level.maxElevations.reserve(distances.size() / 2 + 2);
+    for(int i = 0; i < distances.size(); i += 2)
+    {
+      level.distances.append(distances.at(i));
+      level.maxElevations.append(i + 1 < distances.size() ?
+                                 std::max(elevations.at(i), elevations.at(i + 1)) : elevations.at(i));
+    }
+
+    // Keep the exact leg end point
+    if(level.distances.last() < distances.last())
+    {
+      level.distances.append(distances.last());
+      level.maxElevations.append(elevations.last());
+    }
+
+    distances = level.distances;
+    elevations = level.maxElevations;
+    leg.levels.append(level);
+  }
+}
+
 void ProfileWidget::showEvent(QShowEvent *)
 {
   widgetVisible = true;
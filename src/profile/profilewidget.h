@@ -23,6 +23,7 @@
 
 #include <QFuture>
 #include <QFutureWatcher>
+#include <QPixmap>
 #include <QWidget>
 
 namespace Marble {
@@ -34,6 +35,7 @@ class QMainWindow;
 class RouteController;
 class QTimer;
 class QRubberBand;
+class QPainter;
 
 /*
  * Loads and displays the flight plan elevation profile. The elevation data is
@@ -98,6 +100,13 @@ signals:
   void highlightProfilePoint(const atools::geo::Pos& pos);
 
 private:
+  /* One decimation level of the elevation points of a leg */
+  struct ElevationLevel
+  {
+    QVector<float> distances; /* Distance of the first merged point. Nautical miles. */
+    QVector<float> maxElevations; /* Maximum ground elevation of all merged points. Feet. */
+  };
+
   /* Route leg storing all elevation points */
   struct ElevationLeg
   {
@@ -105,6 +114,10 @@ private:
     QVector<float> distances; /* Distances along the route for each elevation point.
                                *  Measured from departure point. Nautical miles. */
     float maxElevation = 0.f; /* Max ground altitude for this leg */
+
+    /* Pyramid of decimated elevations built by the worker thread. Level n merges 2^(n+1) points
+     * of the full resolution. Keeps peaks since the maximum is used. */
+    QVector<ElevationLevel> levels;
   };
 
   struct ElevationLegList
@@ -118,6 +131,9 @@ private:
   };
 
   virtual void paintEvent(QPaintEvent *) override;
+
+  /* Draw terrain, scale, flight plan and symbols which are cached in staticLayer */
+  void paintStaticLayer(QPainter& painter, bool darkStyle);
   virtual void showEvent(QShowEvent *) override;
   virtual void hideEvent(QHideEvent *) override;
   virtual void mouseMoveEvent(QMouseEvent *mouseEvent) override;
@@ -130,11 +146,17 @@ private:
   void updateTimeout();
   void updateThreadFinished();
   void updateScreenCoords();
+
+  /* Fill ElevationLeg::levels from full resolution elevation data */
+  void buildElevationLevels(ElevationLeg& leg) const;
   void terminateThread();
   float calcGroundBuffer(float maxElevation);
   void updateLabel();
   bool aircraftTrackValid();
 
+  /* Stop decimating if a level has less points */
+  static Q_DECL_CONSTEXPR int MIN_ELEVATION_LEVEL_POINTS = 16;
+
   /* Scale levels to test for display */
   static Q_DECL_CONSTEXPR int NUM_SCALE_STEPS = 5;
   const int SCALE_STEPS[NUM_SCALE_STEPS] = {500, 1000, 2000, 5000, 10000};
@@ -186,6 +208,10 @@ private:
   bool widgetVisible = false, showAircraft = false, showAircraftTrack = false;
   QVector<int> waypointX; /* Flight plan waypoint screen coordinates */
   QPolygon landPolygon; /* Green landmass polygon */
+
+  /* Cached drawing of all parts except aircraft and track. Invalidated when screen coordinates change. */
+  QPixmap staticLayer;
+  bool staticLayerValid = false, staticLayerDarkStyle = false;
   float minSafeAltitudeFt = 0.f /* Red line */,
         flightplanAltFt = 0.f /* Cruise altitude */,
         maxWindowAlt = 1.f /* Maximum altitude at top of widget */,
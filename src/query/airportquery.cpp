@@ -47,19 +47,39 @@ using map::MapHelipad;
 const static float MAX_HEADING_RUNWAY_DEVIATION = 20.f;
 
 AirportQuery::AirportQuery(QObject *parent, atools::sql::SqlDatabase *sqlDb, bool nav)
+  : AirportQuery(parent, sqlDb, nav, readConfig())
+{
+}
+
+AirportQuery::AirportQuery(QObject *parent, atools::sql::SqlDatabase *sqlDb, bool nav, const Config& config)
   : QObject(parent), navdata(nav), db(sqlDb)
 {
   mapTypesFactory = new MapTypesFactory();
+
+  runwayCache.setMaxCost(config.runwayCache);
+  apronCache.setMaxCost(config.apronCache);
+  taxipathCache.setMaxCost(config.taxipathCache);
+  parkingCache.setMaxCost(config.parkingCache);
+  startCache.setMaxCost(config.startCache);
+  helipadCache.setMaxCost(config.helipadCache);
+  airportIdCache.setMaxCost(config.airportIdCache);
+  airportIdentCache.setMaxCost(config.airportIdentCache);
+}
+
+AirportQuery::Config AirportQuery::readConfig()
+{
   atools::settings::Settings& settings = atools::settings::Settings::instance();
 
-  runwayCache.setMaxCost(settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY + "RunwayCache", 2000).toInt());
-  apronCache.setMaxCost(settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY + "ApronCache", 1000).toInt());
-  taxipathCache.setMaxCost(settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY + "TaxipathCache", 1000).toInt());
-  parkingCache.setMaxCost(settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY + "ParkingCache", 1000).toInt());
-  startCache.setMaxCost(settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY + "StartCache", 1000).toInt());
-  helipadCache.setMaxCost(settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY + "HelipadCache", 1000).toInt());
-  airportIdCache.setMaxCost(settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY + "AirportIdCache", 1000).toInt());
-  airportIdentCache.setMaxCost(settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY + "AirportIdentCache", 1000).toInt());
+  Config config;
+  config.runwayCache = settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY + "RunwayCache", 2000).toInt();
+  config.apronCache = settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY + "ApronCache", 1000).toInt();
+  config.taxipathCache = settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY + "TaxipathCache", 1000).toInt();
+  config.parkingCache = settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY + "ParkingCache", 1000).toInt();
+  config.startCache = settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY + "StartCache", 1000).toInt();
+  config.helipadCache = settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY + "HelipadCache", 1000).toInt();
+  config.airportIdCache = settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY + "AirportIdCache", 1000).toInt();
+  config.airportIdentCache = settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY + "AirportIdentCache", 1000).toInt();
+  return config;
 }
 
 AirportQuery::~AirportQuery()
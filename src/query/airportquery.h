@@ -54,11 +54,25 @@ class AirportQuery
   Q_OBJECT
 
 public:
+  /* Cache sizes from settings. Read in the GUI thread and passed to instances used in worker threads. */
+  struct Config
+  {
+    int runwayCache, apronCache, taxipathCache, parkingCache, startCache, helipadCache, airportIdCache,
+        airportIdentCache;
+  };
+
+  /* Read configuration from settings. Call only in the GUI thread. */
+  static Config readConfig();
+
   /*
+   * Reads cache sizes from settings. Use only in the GUI thread.
    * @param sqlDb database for simulator scenery data
    * @param sqlDbNav for updated navaids
    */
   AirportQuery(QObject *parent, atools::sql::SqlDatabase *sqlDb, bool nav);
+
+  /* Does not access settings and can be used in worker threads */
+  AirportQuery(QObject *parent, atools::sql::SqlDatabase *sqlDb, bool nav, const Config& config);
   ~AirportQuery();
 
   void getAirportAdminNamesById(int airportId, QString& city, QString& state, QString& country);
@@ -30,9 +30,16 @@
 #include "settings/settings.h"
 #include "fs/common/xpgeometry.h"
 #include "db/databasemanager.h"
+#include "db/databasepool.h"
+#include "query/navsnapshot.h"
+#include "exception.h"
+#include "sql/sqldatabase.h"
 
 #include <QDataStream>
 #include <QRegularExpression>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <cmath>
 
 using namespace Marble;
 using namespace atools::sql;
@@ -52,13 +59,10 @@ static double queryRectInflationIncrement = 0.1;
 int MapQuery::queryMaxRows = 5000;
 
 MapQuery::MapQuery(QObject *parent, atools::sql::SqlDatabase *sqlDb, SqlDatabase *sqlDbNav, SqlDatabase *sqlDbUser)
-  : QObject(parent), db(sqlDb), dbNav(sqlDbNav), dbUser(sqlDbUser)
+  : MapQuery(parent, sqlDb, sqlDbNav, sqlDbUser, readConfig())
 {
-  mapTypesFactory = new MapTypesFactory();
+  // Static values are shared with instances in worker threads - only set here
   atools::settings::Settings& settings = atools::settings::Settings::instance();
-
-  runwayOverwiewCache.setMaxCost(settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY + "RunwayOverwiewCache",
-                                                           1000).toInt());
   queryRectInflationFactor = settings.getAndStoreValue(
     lnm::SETTINGS_MAPQUERY + "QueryRectInflationFactor", 0.3).toDouble();
   queryRectInflationIncrement = settings.getAndStoreValue(
@@ -67,18 +71,53 @@ MapQuery::MapQuery(QObject *parent, atools::sql::SqlDatabase *sqlDb, SqlDatabase
     lnm::SETTINGS_MAPQUERY + "QueryRowLimit", 5000).toInt();
 }
 
+MapQuery::MapQuery(QObject *parent, atools::sql::SqlDatabase *sqlDb, SqlDatabase *sqlDbNav, SqlDatabase *sqlDbUser,
+                   const Config& config)
+  : QObject(parent), db(sqlDb), dbNav(sqlDbNav), dbUser(sqlDbUser)
+{
+  mapTypesFactory = new MapTypesFactory();
+
+  runwayOverwiewCache.setMaxCost(config.runwayOverwiewCache);
+  navSnapshotEnabled = config.navSnapshot;
+
+  navSnapshot = new NavSnapshot;
+  connect(&navSnapshotWatcher, &QFutureWatcher<bool>::finished, this, &MapQuery::navSnapshotBuilt);
+}
+
+MapQuery::Config MapQuery::readConfig()
+{
+  atools::settings::Settings& settings = atools::settings::Settings::instance();
+
+  Config config;
+  config.runwayOverwiewCache = settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY + "RunwayOverwiewCache",
+                                                         1000).toInt();
+  config.navSnapshot = settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY + "NavSnapshot", true).toBool();
+  return config;
+}
+
 MapQuery::~MapQuery()
 {
   deInitQueries();
+  delete navSnapshot;
   delete mapTypesFactory;
 }
 
+AirportQuery *MapQuery::getAirportQuerySim() const
+{
+  return airportQuerySim != nullptr ? airportQuerySim : NavApp::getAirportQuerySim();
+}
+
+AirportQuery *MapQuery::getAirportQueryNav() const
+{
+  return airportQueryNav != nullptr ? airportQueryNav : NavApp::getAirportQueryNav();
+}
+
 map::MapAirport MapQuery::getAirportSim(const map::MapAirport& airport)
 {
   if(airport.navdata)
   {
     map::MapAirport retval;
-    NavApp::getAirportQuerySim()->getAirportByIdent(retval, airport.ident);
+    getAirportQuerySim()->getAirportByIdent(retval, airport.ident);
     return retval;
   }
   return airport;
@@ -89,7 +128,7 @@ map::MapAirport MapQuery::getAirportNav(const map::MapAirport& airport)
   if(!airport.navdata)
   {
     map::MapAirport retval;
-    NavApp::getAirportQueryNav()->getAirportByIdent(retval, airport.ident);
+    getAirportQueryNav()->getAirportByIdent(retval, airport.ident);
     return retval;
   }
   return airport;
@@ -98,13 +137,13 @@ map::MapAirport MapQuery::getAirportNav(const map::MapAirport& airport)
 void MapQuery::getAirportSimReplace(map::MapAirport& airport)
 {
   if(airport.navdata)
-    NavApp::getAirportQuerySim()->getAirportByIdent(airport, airport.ident);
+    getAirportQuerySim()->getAirportByIdent(airport, airport.ident);
 }
 
 void MapQuery::getAirportNavReplace(map::MapAirport& airport)
 {
   if(!airport.navdata)
-    NavApp::getAirportQueryNav()->getAirportByIdent(airport, airport.ident);
+    getAirportQueryNav()->getAirportByIdent(airport, airport.ident);
 }
 
 void MapQuery::getVorForWaypoint(map::MapVor& vor, int waypointId)
@@ -277,9 +316,9 @@ void MapQuery::mapObjectByIdentInternal(map::MapSearchResult& result, map::MapOb
     map::MapAirport ap;
 
     if(airportFromNavDatabase)
-      NavApp::getAirportQueryNav()->getAirportByIdent(ap, ident);
+      getAirportQueryNav()->getAirportByIdent(ap, ident);
     else
-      NavApp::getAirportQuerySim()->getAirportByIdent(ap, ident);
+      getAirportQuerySim()->getAirportByIdent(ap, ident);
 
     if(ap.isValid())
     {
@@ -352,9 +391,9 @@ void MapQuery::mapObjectByIdentInternal(map::MapSearchResult& result, map::MapOb
   if(type & map::RUNWAYEND)
   {
     if(airportFromNavDatabase)
-      NavApp::getAirportQueryNav()->getRunwayEndByNames(result, ident, airport);
+      getAirportQueryNav()->getRunwayEndByNames(result, ident, airport);
     else
-      NavApp::getAirportQuerySim()->getRunwayEndByNames(result, ident, airport);
+      getAirportQuerySim()->getRunwayEndByNames(result, ident, airport);
   }
 
   if(type & map::AIRWAY)
@@ -376,8 +415,8 @@ void MapQuery::getMapObjectById(map::MapSearchResult& result, map::MapObjectType
   if(type == map::AIRPORT)
   {
     map::MapAirport airport = (airportFromNavDatabase ?
-                               NavApp::getAirportQueryNav() :
-                               NavApp::getAirportQuerySim())->getAirportById(id);
+                               getAirportQueryNav() :
+                               getAirportQuerySim())->getAirportById(id);
     if(airport.isValid())
       result.airports.append(airport);
   }
@@ -414,8 +453,8 @@ void MapQuery::getMapObjectById(map::MapSearchResult& result, map::MapObjectType
   else if(type == map::RUNWAYEND)
   {
     map::MapRunwayEnd end = (airportFromNavDatabase ?
-                             NavApp::getAirportQueryNav() :
-                             NavApp::getAirportQuerySim())->getRunwayEndById(id);
+                             getAirportQueryNav() :
+                             getAirportQuerySim())->getRunwayEndById(id);
     if(end.isValid())
       result.runwayEnds.append(end);
   }
@@ -532,23 +571,28 @@ void MapQuery::getNearestObjects(const CoordinateConverter& conv, const MapLayer
   int x, y;
   if(mapLayer->isAirport() && types.testFlag(map::AIRPORT))
   {
-    for(int i = airportCache.list.size() - 1; i >= 0; i--)
+    const map::MapAirportColumns& columns = airportCache.list;
+    for(int i = columns.size() - 1; i >= 0; i--)
     {
-      const MapAirport& airport = airportCache.list.at(i);
+      // Check positions in compact columns first and create the full object only if needed
+      bool nearby = conv.wToS(columns.positions.at(i), x, y) &&
+                    atools::geo::manhattanDistance(x, y, xs, ys) < screenDistance;
 
+      // Include tower for airport diagrams
+      bool nearbyTower = airportDiagram && conv.wToS(columns.towerCoords.at(i), x, y) &&
+                         atools::geo::manhattanDistance(x, y, xs, ys) < screenDistance;
+
+      if(!nearby && !nearbyTower)
+        continue;
+
+      MapAirport airport = columns.airport(i);
       if(airport.isVisible(types))
       {
-        if(conv.wToS(airport.position, x, y))
-          if((atools::geo::manhattanDistance(x, y, xs, ys)) < screenDistance)
-            insertSortedByDistance(conv, result.airports, &result.airportIds, xs, ys, airport);
+        if(nearby)
+          insertSortedByDistance(conv, result.airports, &result.airportIds, xs, ys, airport);
 
-        if(airportDiagram)
-        {
-          // Include tower for airport diagrams
-          if(conv.wToS(airport.towerCoords, x, y) &&
-             atools::geo::manhattanDistance(x, y, xs, ys) < screenDistance)
-            insertSortedByTowerDistance(conv, result.towers, xs, ys, airport);
-        }
+        if(nearbyTower)
+          insertSortedByTowerDistance(conv, result.towers, xs, ys, airport);
       }
     }
   }
@@ -637,7 +681,7 @@ void MapQuery::getNearestObjects(const CoordinateConverter& conv, const MapLayer
   {
     if(airportDiagram)
     {
-      QHash<int, QList<map::MapParking> > parkingCache = NavApp::getAirportQuerySim()->getParkingCache();
+      QHash<int, QList<map::MapParking> > parkingCache = getAirportQuerySim()->getParkingCache();
 
       // Also check parking and helipads in airport diagrams
       for(int id : parkingCache.keys())
@@ -650,7 +694,7 @@ void MapQuery::getNearestObjects(const CoordinateConverter& conv, const MapLayer
         }
       }
 
-      QHash<int, QList<map::MapHelipad> > helipadCache = NavApp::getAirportQuerySim()->getHelipadCache();
+      QHash<int, QList<map::MapHelipad> > helipadCache = getAirportQuerySim()->getHelipadCache();
 
       for(int id : helipadCache.keys())
       {
@@ -665,7 +709,7 @@ void MapQuery::getNearestObjects(const CoordinateConverter& conv, const MapLayer
   }
 }
 
-const QList<map::MapAirport> *MapQuery::getAirports(const Marble::GeoDataLatLonBox& rect,
+const map::MapAirportColumns *MapQuery::getAirports(const Marble::GeoDataLatLonBox& rect,
                                                     const MapLayer *mapLayer, bool lazy)
 {
   airportCache.updateCache(rect, mapLayer, queryRectInflationFactor, queryRectInflationIncrement, lazy,
@@ -678,15 +722,15 @@ const QList<map::MapAirport> *MapQuery::getAirports(const Marble::GeoDataLatLonB
   {
     case layer::ALL:
       airportByRectQuery->bindValue(":minlength", mapLayer->getMinRunwayLength());
-      return fetchAirports(rect, airportByRectQuery, lazy, false /* overview */);
+      return fetchAirports(rect, airportByRectQuery, airportByRectColumns, lazy, false /* overview */);
 
     case layer::MEDIUM:
       // Airports > 4000 ft
-      return fetchAirports(rect, airportMediumByRectQuery, lazy, true /* overview */);
+      return fetchAirports(rect, airportMediumByRectQuery, airportMediumByRectColumns, lazy, true /* overview */);
 
     case layer::LARGE:
       // Airports > 8000 ft
-      return fetchAirports(rect, airportLargeByRectQuery, lazy, true /* overview */);
+      return fetchAirports(rect, airportLargeByRectQuery, airportLargeByRectColumns, lazy, true /* overview */);
 
   }
   return nullptr;
@@ -706,12 +750,19 @@ const QList<map::MapWaypoint> *MapQuery::getWaypoints(const GeoDataLatLonBox& re
     for(const GeoDataLatLonBox& r :
         query::splitAtAntiMeridian(rect, queryRectInflationFactor, queryRectInflationIncrement))
     {
+      if(navSnapshot->isOpen())
+      {
+        // Read directly from the memory mapped file
+        navSnapshot->getWaypoints(r, waypointCache.list, queryMaxRows);
+        continue;
+      }
+
       query::bindCoordinatePointInRect(r, waypointsByRectQuery);
       waypointsByRectQuery->exec();
       while(waypointsByRectQuery->next())
       {
         map::MapWaypoint wp;
-        mapTypesFactory->fillWaypoint(waypointsByRectQuery->record(), wp);
+        mapTypesFactory->fillWaypoint(waypointsByRectQuery, waypointsByRectColumns, wp);
         waypointCache.list.append(wp);
       }
     }
@@ -739,7 +790,7 @@ const QList<map::MapVor> *MapQuery::getVors(const GeoDataLatLonBox& rect, const
       while(vorsByRectQuery->next())
       {
         map::MapVor vor;
-        mapTypesFactory->fillVor(vorsByRectQuery->record(), vor);
+        mapTypesFactory->fillVor(vorsByRectQuery, vorsByRectColumns, vor);
         vorCache.list.append(vor);
       }
     }
@@ -767,7 +818,7 @@ const QList<map::MapNdb> *MapQuery::getNdbs(const GeoDataLatLonBox& rect, const
       while(ndbsByRectQuery->next())
       {
         map::MapNdb ndb;
-        mapTypesFactory->fillNdb(ndbsByRectQuery->record(), ndb);
+        mapTypesFactory->fillNdb(ndbsByRectQuery, ndbsByRectColumns, ndb);
         ndbCache.list.append(ndb);
       }
     }
@@ -780,50 +831,60 @@ const QList<map::MapUserpoint> MapQuery::getUserdataPoints(const GeoDataLatLonBo
                                                            const QStringList& typesAll, bool unknownType,
                                                            float distance)
 {
-  // No caching here since points can change and the dataset is usually small
   QList<map::MapUserpoint> retval;
   userpointCache.clear();
 
   // Display either unknown or any type
   if(unknownType || !types.isEmpty())
   {
-    bool allTypesSelected = types == typesAll;
+    if(!userpointIndexValid)
+      loadUserpointIndex();
 
     for(const GeoDataLatLonBox& r :
         query::splitAtAntiMeridian(rect, queryRectInflationFactor, queryRectInflationIncrement))
     {
-      query::bindCoordinatePointInRect(r, userdataPointByRectQuery);
-      userdataPointByRectQuery->bindValue(":dist", distance);
+      float west = static_cast<float>(r.west(GeoDataCoordinates::Degree));
+      float east = static_cast<float>(r.east(GeoDataCoordinates::Degree));
+      float south = static_cast<float>(r.south(GeoDataCoordinates::Degree));
+      float north = static_cast<float>(r.north(GeoDataCoordinates::Degree));
 
-      QStringList queryTypes;
-      if(unknownType || (allTypesSelected && unknownType))
-        // Either query all unknows too and filter later or all and unknown are selected
-        queryTypes.append("%");
-      else
-        queryTypes = types;
+      int cellWest = std::max(static_cast<int>(std::floor(west)), -180);
+      int cellEast = std::min(static_cast<int>(std::floor(east)), 180);
+      int cellSouth = std::max(static_cast<int>(std::floor(south)), -90);
+      int cellNorth = std::min(static_cast<int>(std::floor(north)), 90);
 
-      for(const QString& queryType : queryTypes)
+      for(int laty = cellSouth; laty <= cellNorth; laty++)
       {
-        userdataPointByRectQuery->bindValue(":type", queryType);
-        userdataPointByRectQuery->exec();
-        while(userdataPointByRectQuery->next())
+        for(int lonx = cellWest; lonx <= cellEast; lonx++)
         {
-          if(unknownType && !allTypesSelected)
+          auto it = userpointIndexGrid.constFind(userpointGridKey(lonx, laty));
+          if(it == userpointIndexGrid.constEnd())
+            continue;
+
+          for(int index : it.value())
           {
-            // Need to filter manually here
-            QString pointType = userdataPointByRectQuery->valueStr("type");
+            if(retval.size() >= queryMaxRows)
+              return retval;
+
+            const map::MapUserpoint& userPoint = userpointIndex.at(index);
+            const atools::geo::Pos& pos = userPoint.position;
 
-            // Ignore if not unknown and not in selected types
-            if(typesAll.contains(pointType) && !types.contains(pointType))
+            // Grid cells are coarse - check exact rectangle
+            if(pos.getLonX() < west || pos.getLonX() > east || pos.getLatY() < south || pos.getLatY() > north)
+              continue;
+
+            if(!(userpointIndexVisibleFrom.at(index) > distance))
+              continue;
+
+            // Show if type is selected or if type is unknown and unknown types are enabled
+            if(!types.contains(userPoint.type) && !(unknownType && !typesAll.contains(userPoint.type)))
               continue;
-          }
 
-          map::MapUserpoint userPoint;
-          mapTypesFactory->fillUserdataPoint(userdataPointByRectQuery->record(), userPoint);
-          retval.append(userPoint);
+            retval.append(userPoint);
 
-          // Cache has to be kept for map screen index
-          userpointCache.list.append(userPoint);
+            // Cache has to be kept for map screen index
+            userpointCache.list.append(userPoint);
+          }
         }
       }
     }
@@ -831,6 +892,40 @@ const QList<map::MapUserpoint> MapQuery::getUserdataPoints(const GeoDataLatLonBo
   return retval;
 }
 
+void MapQuery::userdataChanged()
+{
+  userpointIndexValid = false;
+}
+
+void MapQuery::loadUserpointIndex()
+{
+  userpointIndex.clear();
+  userpointIndexVisibleFrom.clear();
+  userpointIndexGrid.clear();
+
+  userdataPointsAllQuery->exec();
+  while(userdataPointsAllQuery->next())
+  {
+    map::MapUserpoint userPoint;
+    mapTypesFactory->fillUserdataPoint(userdataPointsAllQuery->record(), userPoint);
+
+    if(!userPoint.position.isValid())
+      continue;
+
+    int lonx = static_cast<int>(std::floor(userPoint.position.getLonX()));
+    int laty = static_cast<int>(std::floor(userPoint.position.getLatY()));
+    userpointIndexGrid[userpointGridKey(lonx, laty)].append(userpointIndex.size());
+
+    userpointIndexVisibleFrom.append(userdataPointsAllQuery->valueFloat("visible_from"));
+    userpointIndex.append(userPoint);
+  }
+  userdataPointsAllQuery->finish();
+
+  userpointIndexValid = true;
+  qDebug() << Q_FUNC_INFO << "Loaded" << userpointIndex.size() << "userpoints into"
+           << userpointIndexGrid.size() << "grid cells";
+}
+
 const QList<map::MapMarker> *MapQuery::getMarkers(const GeoDataLatLonBox& rect, const MapLayer *mapLayer,
                                                   bool lazy)
 {
@@ -850,7 +945,7 @@ const QList<map::MapMarker> *MapQuery::getMarkers(const GeoDataLatLonBox& rect,
       while(markersByRectQuery->next())
       {
         map::MapMarker marker;
-        mapTypesFactory->fillMarker(markersByRectQuery->record(), marker);
+        mapTypesFactory->fillMarker(markersByRectQuery, markersByRectColumns, marker);
         markerCache.list.append(marker);
       }
     }
@@ -877,7 +972,7 @@ const QList<map::MapIls> *MapQuery::getIls(const GeoDataLatLonBox& rect, const M
       while(ilsByRectQuery->next())
       {
         map::MapIls ils;
-        mapTypesFactory->fillIls(ilsByRectQuery->record(), ils);
+        mapTypesFactory->fillIls(ilsByRectQuery, ilsByRectColumns, ils);
         ilsCache.list.append(ils);
       }
     }
@@ -915,7 +1010,7 @@ const QList<map::MapAirway> *MapQuery::getAirways(const GeoDataLatLonBox& rect,
                                             GeoDataCoordinates::GeoDataCoordinates::Degree)))
         {
           map::MapAirway airway;
-          mapTypesFactory->fillAirway(airwayByRectQuery->record(), airway);
+          mapTypesFactory->fillAirway(airwayByRectQuery, airwayByRectColumns, airway);
           airwayCache.list.append(airway);
           ids.insert(airway.id);
         }
@@ -933,13 +1028,14 @@ const QList<map::MapAirway> *MapQuery::getAirways(const GeoDataLatLonBox& rect,
  * @param overview fetch only incomplete data for overview airports
  * @return pointer to the airport cache
  */
-const QList<map::MapAirport> *MapQuery::fetchAirports(const Marble::GeoDataLatLonBox& rect,
-                                                      atools::sql::SqlQuery *query,
+const map::MapAirportColumns *MapQuery::fetchAirports(const Marble::GeoDataLatLonBox& rect,
+                                                      atools::sql::SqlQuery *query, QueryColumns& columns,
                                                       bool lazy, bool overview)
 {
   if(airportCache.list.isEmpty() && !lazy)
   {
     bool navdata = NavApp::getDatabaseManager()->getNavDatabaseStatus() == dm::NAVDATABASE_ALL;
+    bool xplane = NavApp::getCurrentSimulatorDb() == atools::fs::FsPaths::XPLANE11;
     for(const GeoDataLatLonBox& r :
         query::splitAtAntiMeridian(rect, queryRectInflationFactor, queryRectInflationIncrement))
     {
@@ -950,16 +1046,15 @@ const QList<map::MapAirport> *MapQuery::fetchAirports(const Marble::GeoDataLatLo
         map::MapAirport ap;
         if(overview)
           // Fill only a part of the object
-          mapTypesFactory->fillAirportForOverview(query->record(), ap, navdata,
-                                                  NavApp::getCurrentSimulatorDb() == atools::fs::FsPaths::XPLANE11);
+          mapTypesFactory->fillAirportForOverview(query, columns, ap, navdata, xplane);
         else
-          mapTypesFactory->fillAirport(query->record(), ap, true /* complete */, navdata,
-                                       NavApp::getCurrentSimulatorDb() == atools::fs::FsPaths::XPLANE11);
+          mapTypesFactory->fillAirport(query, columns, ap, navdata, xplane);
 
         airportCache.list.append(ap);
       }
     }
   }
+
   airportCache.validate(queryMaxRows);
   return &airportCache.list;
 }
@@ -987,6 +1082,68 @@ const QList<map::MapRunway> *MapQuery::getRunwaysForOverview(int airportId)
   }
 }
 
+void MapQuery::startNavSnapshot()
+{
+  if(!navSnapshotEnabled || navSnapshotBuilding)
+    return;
+
+  navSnapshotSourceFile = dbNav->databaseName();
+  navSnapshotFile = NavSnapshot::snapshotFileName(navSnapshotSourceFile);
+
+  if(NavSnapshot::isValidFor(navSnapshotSourceFile, navSnapshotFile))
+    navSnapshot->open(navSnapshotSourceFile, navSnapshotFile);
+  else if(NavApp::getDatabaseManager()->getDatabasePool() != nullptr)
+  {
+    // Build in background - SQL is used until the snapshot is ready
+    qDebug() << Q_FUNC_INFO << "Building" << navSnapshotFile;
+    navSnapshotCancel = false;
+    navSnapshotBuilding = true;
+    navSnapshotFuture = QtConcurrent::run(this, &MapQuery::buildNavSnapshot, navSnapshotSourceFile, navSnapshotFile);
+    navSnapshotWatcher.setFuture(navSnapshotFuture);
+  }
+}
+
+void MapQuery::stopNavSnapshot()
+{
+  if(navSnapshotBuilding)
+  {
+    // Pooled connections are closed after this - stop worker first
+    navSnapshotCancel = true;
+    navSnapshotFuture.waitForFinished();
+    navSnapshotBuilding = false;
+  }
+  navSnapshot->close();
+}
+
+bool MapQuery::buildNavSnapshot(QString sourceFile, QString snapshotFile)
+{
+  DatabasePool *pool = NavApp::getDatabaseManager()->getDatabasePool();
+  bool success = false;
+  try
+  {
+    SqlDatabase *poolDb = pool->getDatabase(dbpool::NAV);
+    if(poolDb != nullptr)
+      success = NavSnapshot::build(poolDb, sourceFile, snapshotFile, navSnapshotCancel);
+  }
+  catch(atools::Exception& e)
+  {
+    qWarning() << Q_FUNC_INFO << "Building snapshot failed" << e.what();
+  }
+  pool->releaseThread();
+  return success;
+}
+
+void MapQuery::navSnapshotBuilt()
+{
+  if(!navSnapshotBuilding)
+    // Already stopped by deInitQueries
+    return;
+
+  navSnapshotBuilding = false;
+  if(navSnapshotFuture.result() && navSnapshotSourceFile == dbNav->databaseName())
+    navSnapshot->open(navSnapshotSourceFile, navSnapshotFile);
+}
+
 void MapQuery::initQueries()
 {
   // Common where clauses
@@ -1065,8 +1222,11 @@ void MapQuery::initQueries()
   waypointByIdQuery = new SqlQuery(dbNav);
   waypointByIdQuery->prepare("select " + waypointQueryBase + " from waypoint where waypoint_id = :id");
 
-  userdataPointByIdQuery = new SqlQuery(dbUser);
-  userdataPointByIdQuery->prepare("select * from userdata where userdata_id = :id");
+  if(dbUser != nullptr)
+  {
+    userdataPointByIdQuery = new SqlQuery(dbUser);
+    userdataPointByIdQuery->prepare("select * from userdata where userdata_id = :id");
+  }
 
   ilsByIdQuery = new SqlQuery(db);
   ilsByIdQuery->prepare("select " + ilsQueryBase + " from ils where ils_id = :id");
@@ -1105,10 +1265,11 @@ void MapQuery::initQueries()
   ndbsByRectQuery = new SqlQuery(dbNav);
   ndbsByRectQuery->prepare("select " + ndbQueryBase + " from ndb where " + whereRect + " " + whereLimit);
 
-  userdataPointByRectQuery = new SqlQuery(dbUser);
-  userdataPointByRectQuery->prepare("select * from userdata "
-                                    "where " + whereRect + " and visible_from > :dist and type like :type " +
-                                    whereLimit);
+  if(dbUser != nullptr)
+  {
+    userdataPointsAllQuery = new SqlQuery(dbUser);
+    userdataPointsAllQuery->prepare("select * from userdata order by userdata_id");
+  }
 
   markersByRectQuery = new SqlQuery(dbNav);
   markersByRectQuery->prepare(
@@ -1158,10 +1319,16 @@ void MapQuery::initQueries()
   airwayWaypointsQuery = new SqlQuery(dbNav);
   airwayWaypointsQuery->prepare("select " + airwayQueryBase + " from airway where airway_name = :name "
                                                               " order by airway_fragment_no, sequence_no");
+
+  if(dbUser != nullptr)
+    // Only for the GUI instance
+    startNavSnapshot();
 }
 
 void MapQuery::deInitQueries()
 {
+  stopNavSnapshot();
+
   airportCache.clear();
   waypointCache.clear();
   vorCache.clear();
@@ -1169,8 +1336,24 @@ void MapQuery::deInitQueries()
   markerCache.clear();
   ilsCache.clear();
   airwayCache.clear();
+  userpointCache.clear();
   runwayOverwiewCache.clear();
 
+  userpointIndex.clear();
+  userpointIndexVisibleFrom.clear();
+  userpointIndexGrid.clear();
+  userpointIndexValid = false;
+
+  airportByRectColumns.reset();
+  airportMediumByRectColumns.reset();
+  airportLargeByRectColumns.reset();
+  waypointsByRectColumns.reset();
+  vorsByRectColumns.reset();
+  ndbsByRectColumns.reset();
+  markersByRectColumns.reset();
+  ilsByRectColumns.reset();
+  airwayByRectColumns.reset();
+
   delete airportByRectQuery;
   airportByRectQuery = nullptr;
   delete airportMediumByRectQuery;
@@ -1194,8 +1377,8 @@ void MapQuery::deInitQueries()
   delete airwayByRectQuery;
   airwayByRectQuery = nullptr;
 
-  delete userdataPointByRectQuery;
-  userdataPointByRectQuery = nullptr;
+  delete userdataPointsAllQuery;
+  userdataPointsAllQuery = nullptr;
 
   delete airwayByWaypointIdQuery;
   airwayByWaypointIdQuery = nullptr;
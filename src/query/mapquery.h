@@ -20,8 +20,13 @@
 
 #include "query/querytypes.h"
 #include "common/maptypes.h"
+#include "common/maptypesfactory.h"
 
 #include <QCache>
+#include <QHash>
+#include <QFutureWatcher>
+
+#include <atomic>
 
 namespace atools {
 namespace geo {
@@ -34,8 +39,9 @@ class SqlQuery;
 }
 
 class CoordinateConverter;
-class MapTypesFactory;
 class MapLayer;
+class NavSnapshot;
+class AirportQuery;
 
 /*
  * Provides map related database queries. Fill objects of the maptypes namespace and maintains a cache.
@@ -49,12 +55,29 @@ class MapQuery
   Q_OBJECT
 
 public:
+  /* Instance settings. Read in the GUI thread and passed to instances used in worker threads. */
+  struct Config
+  {
+    int runwayOverwiewCache;
+    bool navSnapshot;
+  };
+
+  /* Read configuration from settings. Call only in the GUI thread. */
+  static Config readConfig();
+
   /*
+   * Reads settings and sets the query limits shared by all instances. Use only in the GUI thread.
    * @param sqlDb database for simulator scenery data
    * @param sqlDbNav for updated navaids
+   * @param sqlDbUser userpoints. Can be null for instances in worker threads which do not need userpoints.
+   * The navdata snapshot is not used in this case.
    */
   MapQuery(QObject *parent, atools::sql::SqlDatabase *sqlDb, atools::sql::SqlDatabase *sqlDbNav,
            atools::sql::SqlDatabase *sqlDbUser);
+
+  /* Does not access settings and can be used in worker threads */
+  MapQuery(QObject *parent, atools::sql::SqlDatabase *sqlDb, atools::sql::SqlDatabase *sqlDbNav,
+           atools::sql::SqlDatabase *sqlDbUser, const Config& config);
   ~MapQuery();
 
   /* Convert airport instances from/to simulator and third party nav databases */
@@ -141,10 +164,11 @@ public:
    * @param rect bounding rectangle for query
    * @param mapLayer used to find source table
    * @param lazy do not reload from database and return (probably incomplete) result from cache if true
-   * @return pointer to airport cache. Create a copy if this is needed for a longer
-   * time than for e.g. one drawing request.
+   * @return pointer to the compact airport cache. Use MapAirportColumns::airport() to get full objects.
+   * Valid only for e.g. one drawing request.
    */
-  const QList<map::MapAirport> *getAirports(const Marble::GeoDataLatLonBox& rect, const MapLayer *mapLayer, bool lazy);
+  const map::MapAirportColumns *getAirports(const Marble::GeoDataLatLonBox& rect, const MapLayer *mapLayer,
+                                            bool lazy);
 
   /* Similar to getAirports */
   const QList<map::MapWaypoint> *getWaypoints(const Marble::GeoDataLatLonBox& rect, const MapLayer *mapLayer,
@@ -168,34 +192,72 @@ public:
   /* Get a partially filled runway list for the overview */
   const QList<map::MapRunway> *getRunwaysForOverview(int airportId);
 
-  /* Similar to getAirports but no caching since user points can change */
+  /* Similar to getAirports but served from an in-memory grid index of all user points which is loaded once
+   * and reloaded after userdataChanged() was called */
   const QList<map::MapUserpoint> getUserdataPoints(const Marble::GeoDataLatLonBox& rect, const QStringList& types,
                                                    const QStringList& typesAll,
                                                    bool unknownType, float distance);
 
+  /* Marks the user point index as dirty. Has to be called after any change to the userdata database
+   * like add, edit, delete, move or import */
+  void userdataChanged();
+
   /* Close all query objects thus disconnecting from the database */
   void initQueries();
 
   /* Create and prepare all queries */
   void deInitQueries();
 
+  /* Use the given airport queries instead of the ones from NavApp. Needed for instances in worker threads
+   * which have to use their own database connections. */
+  void setAirportQueries(AirportQuery *airportQuerySimParam, AirportQuery *airportQueryNavParam)
+  {
+    airportQuerySim = airportQuerySimParam;
+    airportQueryNav = airportQueryNavParam;
+  }
+
 private:
+  /* Airport queries set by setAirportQueries or from NavApp */
+  AirportQuery *getAirportQuerySim() const;
+  AirportQuery *getAirportQueryNav() const;
+
   void mapObjectByIdentInternal(map::MapSearchResult& result, map::MapObjectTypes type,
                                 const QString& ident, const QString& region, const QString& airport,
                                 const atools::geo::Pos& sortByDistancePos,
                                 float maxDistance, bool airportFromNavDatabase);
 
-  const QList<map::MapAirport> *fetchAirports(const Marble::GeoDataLatLonBox& rect,
-                                              atools::sql::SqlQuery *query,
+  const map::MapAirportColumns *fetchAirports(const Marble::GeoDataLatLonBox& rect,
+                                              atools::sql::SqlQuery *query, QueryColumns& columns,
                                               bool lazy, bool overview);
 
   bool runwayCompare(const map::MapRunway& r1, const map::MapRunway& r2);
 
+  /* Open the waypoint snapshot for the current navdata database or build it in background if outdated */
+  void startNavSnapshot();
+
+  /* Cancel a running snapshot build, wait for it and close the snapshot */
+  void stopNavSnapshot();
+
+  /* Background thread. Builds the snapshot using a pooled connection. */
+  bool buildNavSnapshot(QString sourceFile, QString snapshotFile);
+
+  /* Called by watcher when the snapshot build is finished */
+  void navSnapshotBuilt();
+
+  /* Load all user points into userpointIndex and build the grid */
+  void loadUserpointIndex();
+
+  /* Key for a one by one degree grid cell */
+  static int userpointGridKey(int lonx, int laty)
+  {
+    return (laty + 90) * 361 + (lonx + 180);
+  }
+
   MapTypesFactory *mapTypesFactory;
   atools::sql::SqlDatabase *db, *dbNav, *dbUser;
 
   /* Simple bounding rectangle caches */
-  SimpleRectCache<map::MapAirport> airportCache;
+  SimpleRectCache<map::MapAirport, map::MapAirportColumns> airportCache;
   SimpleRectCache<map::MapWaypoint> waypointCache;
   SimpleRectCache<map::MapUserpoint> userpointCache;
   SimpleRectCache<map::MapVor> vorCache;
@@ -204,6 +266,24 @@ private:
   SimpleRectCache<map::MapIls> ilsCache;
   SimpleRectCache<map::MapAirway> airwayCache;
 
+  /* All user points with their visible from distance and a one degree grid of indexes into the list.
+   * Loaded lazily and invalidated by userdataChanged() */
+  QVector<map::MapUserpoint> userpointIndex;
+  QVector<float> userpointIndexVisibleFrom;
+  QHash<int, QVector<int> > userpointIndexGrid;
+  bool userpointIndexValid = false;
+
+  /* Set for worker instances - otherwise null and NavApp queries are used */
+  AirportQuery *airportQuerySim = nullptr, *airportQueryNav = nullptr;
+
+  /* Memory mapped waypoint snapshot used instead of waypointsByRectQuery if open */
+  NavSnapshot *navSnapshot = nullptr;
+  QString navSnapshotSourceFile, navSnapshotFile;
+  QFuture<bool> navSnapshotFuture;
+  QFutureWatcher<bool> navSnapshotWatcher;
+  std::atomic_bool navSnapshotCancel {false};
+  bool navSnapshotBuilding = false, navSnapshotEnabled = true;
+
   /* ID/object caches */
   QCache<int, QList<map::MapRunway> > runwayOverwiewCache;
 
@@ -216,7 +296,12 @@ private:
 
   atools::sql::SqlQuery *waypointsByRectQuery = nullptr, *vorsByRectQuery = nullptr,
                         *ndbsByRectQuery = nullptr, *markersByRectQuery = nullptr, *ilsByRectQuery = nullptr,
-                        *airwayByRectQuery = nullptr, *userdataPointByRectQuery = nullptr;
+                        *airwayByRectQuery = nullptr, *userdataPointsAllQuery = nullptr;
+
+  /* Column indexes for the rectangle queries above. Resolved on first row and reset in deInitQueries */
+  QueryColumns airportByRectColumns, airportMediumByRectColumns, airportLargeByRectColumns,
+               waypointsByRectColumns, vorsByRectColumns, ndbsByRectColumns, markersByRectColumns,
+               ilsByRectColumns, airwayByRectColumns;
 
   atools::sql::SqlQuery *vorByIdentQuery = nullptr, *ndbByIdentQuery = nullptr, *waypointByIdentQuery = nullptr,
                         *ilsByIdentQuery = nullptr;
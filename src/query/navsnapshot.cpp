@@ -0,0 +1,363 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "query/navsnapshot.h"
+
+#include "common/maptypes.h"
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+#include "sql/sqlutil.h"
+#include "exception.h"
+
+#include <marble/GeoDataLatLonBox.h>
+
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QStandardPaths>
+#include <QVector>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+using atools::sql::SqlQuery;
+using atools::sql::SqlDatabase;
+using Marble::GeoDataLatLonBox;
+using Marble::GeoDataCoordinates;
+
+namespace {
+
+const char SNAPSHOT_MAGIC[8] = {'L', 'N', 'M', 'S', 'N', 'A', 'P', '\0'};
+const quint32 SNAPSHOT_VERSION = 1;
+const quint32 SNAPSHOT_BYTE_ORDER = 0x01020304;
+
+/* One by one degree tiles */
+const int NUM_TILES_LON = 360;
+const int NUM_TILES_LAT = 180;
+const int NUM_TILES = NUM_TILES_LON * NUM_TILES_LAT;
+
+struct SnapshotHeader
+{
+  char magic[8];
+  quint32 version;
+  quint32 byteOrder;
+  qint64 sourceSize;
+  qint64 sourceModified;
+  quint32 numWaypoints;
+  quint32 numTiles;
+};
+
+/* Fixed size waypoint record. Strings are zero padded and not terminated if they fill the field. */
+struct WaypointRecord
+{
+  qint32 id;
+  float lonx, laty, magvar;
+  quint16 numVictorAirway, numJetAirway;
+  char ident[8], region[4], type[8];
+};
+
+static_assert(sizeof(SnapshotHeader) == 40, "Unexpected snapshot header size");
+static_assert(sizeof(WaypointRecord) == 40, "Unexpected snapshot waypoint record size");
+
+/* Size of the tile index which contains the first record index for each tile plus the end index */
+const qint64 TILE_INDEX_SIZE = (NUM_TILES + 1) * static_cast<qint64>(sizeof(quint32));
+
+int tileLon(float lonx)
+{
+  return std::min(std::max(static_cast<int>(std::floor(lonx)) + 180, 0), NUM_TILES_LON - 1);
+}
+
+int tileLat(float laty)
+{
+  return std::min(std::max(static_cast<int>(std::floor(laty)) + 90, 0), NUM_TILES_LAT - 1);
+}
+
+/* Copy string into fixed size field. Returns false if it does not fit. */
+template<int SIZE>
+bool copyString(char (&field)[SIZE], const QString& str)
+{
+  QByteArray bytes = str.toLatin1();
+  if(bytes.size() > SIZE)
+    return false;
+
+  std::memset(field, 0, SIZE);
+  std::memcpy(field, bytes.constData(), static_cast<size_t>(bytes.size()));
+  return true;
+}
+
+template<int SIZE>
+QString toString(const char (&field)[SIZE])
+{
+  return QString::fromLatin1(field, static_cast<int>(qstrnlen(field, SIZE)));
+}
+
+bool readHeader(const QString& snapshotFile, SnapshotHeader& header)
+{
+  QFile file(snapshotFile);
+  if(file.open(QIODevice::ReadOnly))
+    return file.read(reinterpret_cast<char *>(&header), sizeof(header)) == sizeof(header);
+
+  return false;
+}
+
+bool isHeaderValid(const SnapshotHeader& header, const QString& sourceFile)
+{
+  QFileInfo sourceInfo(sourceFile);
+  return std::memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) == 0 &&
+         header.version == SNAPSHOT_VERSION &&
+         header.byteOrder == SNAPSHOT_BYTE_ORDER &&
+         header.numTiles == NUM_TILES &&
+         header.sourceSize == sourceInfo.size() &&
+         header.sourceModified == sourceInfo.lastModified().toMSecsSinceEpoch();
+}
+
+}
+
+NavSnapshot::NavSnapshot()
+{
+
+}
+
+NavSnapshot::~NavSnapshot()
+{
+  close();
+}
+
+QString NavSnapshot::snapshotFileName(const QString& sourceFile)
+{
+  return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QDir::separator() +
+         QFileInfo(sourceFile).completeBaseName() + ".snapshot";
+}
+
+bool NavSnapshot::build(SqlDatabase *db, const QString& sourceFile, const QString& snapshotFile,
+                        const std::atomic_bool& cancel)
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  QVector<WaypointRecord> records;
+  QVector<int> tiles;
+  try
+  {
+    if(!atools::sql::SqlUtil(db).hasTable("waypoint"))
+      return false;
+
+    SqlQuery query(db);
+    query.exec("select waypoint_id, ident, region, type, num_victor_airway, num_jet_airway, mag_var, lonx, laty "
+               "from waypoint");
+
+    while(query.next())
+    {
+      if(records.size() % 10000 == 0 && cancel)
+        return false;
+
+      WaypointRecord rec;
+      rec.id = query.value(0).toInt();
+      if(!copyString(rec.ident, query.value(1).toString()) ||
+         !copyString(rec.region, query.value(2).toString()) ||
+         !copyString(rec.type, query.value(3).toString()))
+      {
+        // Cannot be represented - do not use a snapshot for this database
+        qWarning() << Q_FUNC_INFO << "Value too long for waypoint" << rec.id;
+        return false;
+      }
+      rec.numVictorAirway = static_cast<quint16>(std::min(query.value(4).toInt(), 0xffff));
+      rec.numJetAirway = static_cast<quint16>(std::min(query.value(5).toInt(), 0xffff));
+      rec.magvar = query.value(6).toFloat();
+      rec.lonx = query.value(7).toFloat();
+      rec.laty = query.value(8).toFloat();
+
+      records.append(rec);
+      tiles.append(tileLat(rec.laty) * NUM_TILES_LON + tileLon(rec.lonx));
+    }
+  }
+  catch(atools::Exception& e)
+  {
+    qWarning() << Q_FUNC_INFO << "Reading waypoints failed" << e.what();
+    return false;
+  }
+
+  // Sort records by tile keeping database order inside a tile
+  QVector<int> order(records.size());
+  for(int i = 0; i < order.size(); i++)
+    order[i] = i;
+  std::stable_sort(order.begin(), order.end(), [&tiles](int i1, int i2) -> bool
+  {
+    return tiles.at(i1) < tiles.at(i2);
+  });
+
+  // Build tile index with first record index per tile
+  QVector<quint32> tileIndex(NUM_TILES + 1, 0);
+  for(int tile : tiles)
+    tileIndex[tile + 1]++;
+  for(int i = 1; i <= NUM_TILES; i++)
+    tileIndex[i] += tileIndex.at(i - 1);
+
+  QFileInfo sourceInfo(sourceFile);
+  SnapshotHeader header;
+  std::memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+  header.version = SNAPSHOT_VERSION;
+  header.byteOrder = SNAPSHOT_BYTE_ORDER;
+  header.sourceSize = sourceInfo.size();
+  header.sourceModified = sourceInfo.lastModified().toMSecsSinceEpoch();
+  header.numWaypoints = static_cast<quint32>(records.size());
+  header.numTiles = NUM_TILES;
+
+  // Write to temporary file and rename when done
+  QDir().mkpath(QFileInfo(snapshotFile).absolutePath());
+  QString tempFile = snapshotFile + ".tmp";
+  QFile file(tempFile);
+  if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot open" << tempFile << file.errorString();
+    return false;
+  }
+
+  bool ok = file.write(reinterpret_cast<const char *>(&header), sizeof(header)) == sizeof(header);
+  ok &= file.write(reinterpret_cast<const char *>(tileIndex.constData()), TILE_INDEX_SIZE) == TILE_INDEX_SIZE;
+
+  for(int i = 0; i < order.size() && ok; i++)
+    ok &= file.write(reinterpret_cast<const char *>(&records.at(order.at(i))), sizeof(WaypointRecord)) ==
+          sizeof(WaypointRecord);
+  file.close();
+
+  if(!ok || cancel)
+  {
+    qWarning() << Q_FUNC_INFO << "Writing" << tempFile << "failed or cancelled" << file.errorString();
+    QFile::remove(tempFile);
+    return false;
+  }
+
+  QFile::remove(snapshotFile);
+  if(!QFile::rename(tempFile, snapshotFile))
+  {
+    qWarning() << Q_FUNC_INFO << "Renaming" << tempFile << "to" << snapshotFile << "failed";
+    QFile::remove(tempFile);
+    return false;
+  }
+
+  qInfo() << Q_FUNC_INFO << "Wrote" << records.size() << "waypoints to" << snapshotFile
+          << "in" << timer.elapsed() << "ms";
+  return true;
+}
+
+bool NavSnapshot::isValidFor(const QString& sourceFile, const QString& snapshotFile)
+{
+  SnapshotHeader header;
+  return readHeader(snapshotFile, header) && isHeaderValid(header, sourceFile);
+}
+
+bool NavSnapshot::open(const QString& sourceFile, const QString& snapshotFile)
+{
+  close();
+
+  file.setFileName(snapshotFile);
+  if(!file.open(QIODevice::ReadOnly))
+    return false;
+
+  qint64 size = file.size();
+  if(size >= static_cast<qint64>(sizeof(SnapshotHeader)) + TILE_INDEX_SIZE)
+  {
+    const uchar *mapped = file.map(0, size);
+    if(mapped != nullptr)
+    {
+      const SnapshotHeader *header = reinterpret_cast<const SnapshotHeader *>(mapped);
+      qint64 expectedSize = static_cast<qint64>(sizeof(SnapshotHeader)) + TILE_INDEX_SIZE +
+                            static_cast<qint64>(header->numWaypoints) * static_cast<qint64>(sizeof(WaypointRecord));
+
+      if(isHeaderValid(*header, sourceFile) && size == expectedSize)
+      {
+        data = mapped;
+        dataSize = size;
+        tileIndex = reinterpret_cast<const quint32 *>(mapped + sizeof(SnapshotHeader));
+        waypointRecords = mapped + sizeof(SnapshotHeader) + TILE_INDEX_SIZE;
+        numWaypoints = header->numWaypoints;
+
+        qInfo() << Q_FUNC_INFO << "Opened" << snapshotFile << "with" << numWaypoints << "waypoints";
+        return true;
+      }
+      file.unmap(const_cast<uchar *>(mapped));
+    }
+  }
+
+  qWarning() << Q_FUNC_INFO << "Snapshot" << snapshotFile << "is not valid";
+  file.close();
+  return false;
+}
+
+void NavSnapshot::close()
+{
+  if(data != nullptr)
+    file.unmap(const_cast<uchar *>(data));
+
+  data = nullptr;
+  dataSize = 0;
+  tileIndex = nullptr;
+  waypointRecords = nullptr;
+  numWaypoints = 0;
+
+  if(file.isOpen())
+    file.close();
+}
+
+void NavSnapshot::getWaypoints(const GeoDataLatLonBox& rect, QList<map::MapWaypoint>& waypoints,
+                               int maxRows) const
+{
+  if(!isOpen())
+    return;
+
+  float west = static_cast<float>(rect.west(GeoDataCoordinates::Degree));
+  float east = static_cast<float>(rect.east(GeoDataCoordinates::Degree));
+  float south = static_cast<float>(rect.south(GeoDataCoordinates::Degree));
+  float north = static_cast<float>(rect.north(GeoDataCoordinates::Degree));
+
+  const WaypointRecord *records = static_cast<const WaypointRecord *>(waypointRecords);
+  int numRows = 0;
+
+  for(int lat = tileLat(south); lat <= tileLat(north); lat++)
+  {
+    // Records of adjacent tiles in one row are stored consecutively
+    int tileFrom = lat * NUM_TILES_LON + tileLon(west);
+    int tileTo = lat * NUM_TILES_LON + tileLon(east);
+
+    for(quint32 i = tileIndex[tileFrom]; i < tileIndex[tileTo + 1] && i < numWaypoints; i++)
+    {
+      const WaypointRecord& rec = records[i];
+
+      // Same as "lonx between :leftx and :rightx and laty between :bottomy and :topy"
+      if(rec.lonx < west || rec.lonx > east || rec.laty < south || rec.laty > north)
+        continue;
+
+      if(numRows++ >= maxRows)
+        return;
+
+      map::MapWaypoint wp;
+      wp.id = rec.id;
+      wp.ident = toString(rec.ident);
+      wp.region = toString(rec.region);
+      wp.type = toString(rec.type);
+      wp.magvar = rec.magvar;
+      wp.hasVictorAirways = rec.numVictorAirway > 0;
+      wp.hasJetAirways = rec.numJetAirway > 0;
+      wp.position = atools::geo::Pos(rec.lonx, rec.laty);
+      waypoints.append(wp);
+    }
+  }
+}
@@ -0,0 +1,94 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLENAVMAP_NAVSNAPSHOT_H
+#define LITTLENAVMAP_NAVSNAPSHOT_H
+
+#include <QFile>
+#include <QList>
+
+#include <atomic>
+
+namespace atools {
+namespace sql {
+class SqlDatabase;
+}
+}
+
+namespace Marble {
+class GeoDataLatLonBox;
+}
+
+namespace map {
+struct MapWaypoint;
+
+}
+
+/*
+ * Read-only binary snapshot of the navdata waypoint table for map display.
+ *
+ * The file is built after a database load and memory mapped. It contains a header, a table of
+ * record ranges for one by one degree tiles and fixed size POD waypoint records sorted by tile.
+ * Queries by rectangle read the tiles covered directly from the mapped file without any SQL.
+ *
+ * The header keeps size and modification time of the source database. A snapshot is only used
+ * if these match the currently opened database. Byte order is native since the file is a local cache.
+ */
+class NavSnapshot
+{
+public:
+  NavSnapshot();
+  ~NavSnapshot();
+
+  /* Build snapshot from the waypoint table of the given database. Can be called from a worker thread.
+   * Writes to a temporary file first and renames it on success.
+   * @param cancel checked periodically. Building stops and returns false if set.
+   * @return true if the file was written successfully */
+  static bool build(atools::sql::SqlDatabase *db, const QString& sourceFile, const QString& snapshotFile,
+                    const std::atomic_bool& cancel);
+
+  /* true if the snapshot file exists, has the current version and matches the source database */
+  static bool isValidFor(const QString& sourceFile, const QString& snapshotFile);
+
+  /* Snapshot file name in the cache directory for the given database file */
+  static QString snapshotFileName(const QString& sourceFile);
+
+  /* Map file into memory. Returns false if the file is not valid for the source database. */
+  bool open(const QString& sourceFile, const QString& snapshotFile);
+  void close();
+
+  bool isOpen() const
+  {
+    return data != nullptr;
+  }
+
+  /* Append all waypoints inside the rectangle to the list. Stops after maxRows.
+   * Same result as a "lonx between ... and laty between ..." query on the waypoint table. */
+  void getWaypoints(const Marble::GeoDataLatLonBox& rect, QList<map::MapWaypoint>& waypoints, int maxRows) const;
+
+private:
+  QFile file;
+  const uchar *data = nullptr;
+  qint64 dataSize = 0;
+
+  /* Pointers into mapped data */
+  const quint32 *tileIndex = nullptr;
+  const void *waypointRecords = nullptr;
+  quint32 numWaypoints = 0;
+};
+
+#endif // LITTLENAVMAP_NAVSNAPSHOT_H
@@ -0,0 +1,560 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#include "query/procedurecache.h"
+
+#include "common/proctypes.h"
+#include "query/mapquery.h"
+#include "geo/line.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QStandardPaths>
+
+#include <algorithm>
+#include <cstring>
+
+using atools::geo::Pos;
+using atools::geo::Line;
+using atools::geo::LineString;
+using atools::geo::Rect;
+using proc::MapProcedureLeg;
+using proc::MapProcedureLegs;
+
+namespace {
+
+const char CACHE_MAGIC[8] = {'L', 'N', 'M', 'P', 'R', 'O', 'C', '\0'};
+const quint32 CACHE_VERSION = 2;
+const quint32 CACHE_BYTE_ORDER = 0x01020304;
+
+/* Version of the serialized records */
+const int STREAM_VERSION = QDataStream::Qt_5_5;
+
+/* Maximum length of the key string including cycle, units and simulator database hash */
+const int KEY_SIZE = 128;
+
+struct CacheHeader
+{
+  char magic[8];
+  quint32 version;
+  quint32 byteOrder;
+  qint64 sourceSize;
+  qint64 sourceModified;
+  char key[KEY_SIZE];
+  quint32 numRecords;
+  quint32 reserved;
+};
+
+static_assert(sizeof(CacheHeader) == 168, "Unexpected procedure cache header size");
+static_assert(sizeof(ProcedureCache::IndexEntry) == 24, "Unexpected procedure cache index entry size");
+
+bool readHeader(const QString& cacheFile, CacheHeader& header)
+{
+  QFile file(cacheFile);
+  if(file.open(QIODevice::ReadOnly))
+    return file.read(reinterpret_cast<char *>(&header), sizeof(header)) == sizeof(header);
+
+  return false;
+}
+
+bool isHeaderValid(const CacheHeader& header, const QString& sourceFile, const QString& key)
+{
+  QFileInfo sourceInfo(sourceFile);
+  QByteArray keyBytes = key.toUtf8().left(KEY_SIZE - 1);
+  return std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0 &&
+         header.version == CACHE_VERSION &&
+         header.byteOrder == CACHE_BYTE_ORDER &&
+         header.sourceSize == sourceInfo.size() &&
+         header.sourceModified == sourceInfo.lastModified().toMSecsSinceEpoch() &&
+         qstrncmp(header.key, keyBytes.constData(), KEY_SIZE) == 0;
+}
+
+bool indexLessThan(const ProcedureCache::IndexEntry& entry1, const ProcedureCache::IndexEntry& entry2)
+{
+  return entry1.kind < entry2.kind || (entry1.kind == entry2.kind && entry1.id < entry2.id);
+}
+
+/* Serialization ====================================================================
+ * Navaids are stored by ID and loaded again when reading since they are only needed for display.
+ * Runway ends have no ID and are stored completely. */
+
+void writeIds(QDataStream& out, const QVector<int>& ids)
+{
+  out << static_cast<qint32>(ids.size());
+  for(int id : ids)
+    out << static_cast<qint32>(id);
+}
+
+template<typename TYPE>
+void writeObjectIds(QDataStream& out, const QList<TYPE>& objects)
+{
+  QVector<int> ids;
+  for(const TYPE& obj : objects)
+    ids.append(obj.id);
+  writeIds(out, ids);
+}
+
+void readObjectIds(QDataStream& in, map::MapSearchResult& result, map::MapObjectTypes type, MapQuery *mapQuery)
+{
+  qint32 size, id;
+  in >> size;
+  for(qint32 i = 0; i < size; i++)
+  {
+    in >> id;
+    mapQuery->getMapObjectById(result, type, id, true /* airport from nav database */);
+  }
+}
+
+void writeRunwayEnd(QDataStream& out, const map::MapRunwayEnd& end)
+{
+  out << end.name << end.heading << end.position << end.secondary << end.navdata;
+}
+
+void readRunwayEnd(QDataStream& in, map::MapRunwayEnd& end)
+{
+  in >> end.name >> end.heading >> end.position >> end.secondary >> end.navdata;
+}
+
+void writeLine(QDataStream& out, const Line& line)
+{
+  out << line.getPos1() << line.getPos2();
+}
+
+void readLine(QDataStream& in, Line& line)
+{
+  Pos pos1, pos2;
+  in >> pos1 >> pos2;
+  line = Line(pos1, pos2);
+}
+
+void writeLineString(QDataStream& out, const LineString& lineString)
+{
+  out << static_cast<qint32>(lineString.size());
+  for(const Pos& pos : lineString)
+    out << pos;
+}
+
+void readLineString(QDataStream& in, LineString& lineString)
+{
+  qint32 size;
+  in >> size;
+  lineString.clear();
+  for(qint32 i = 0; i < size; i++)
+  {
+    Pos pos;
+    in >> pos;
+    lineString.append(pos);
+  }
+}
+
+void writeLeg(QDataStream& out, const MapProcedureLeg& leg)
+{
+  out << leg.fixType << leg.fixIdent << leg.fixRegion
+      << leg.recFixType << leg.recFixIdent << leg.recFixRegion
+      << leg.turnDirection << leg.arincDescrCode
+      << leg.displayText << leg.remarks
+      << leg.fixPos << leg.recFixPos << leg.interceptPos << leg.procedureTurnPos;
+
+  writeLine(out, leg.line);
+  writeLine(out, leg.holdLine);
+  writeLineString(out, leg.geometry);
+
+  writeObjectIds(out, leg.navaids.airports);
+  writeObjectIds(out, leg.navaids.waypoints);
+  writeObjectIds(out, leg.navaids.vors);
+  writeObjectIds(out, leg.navaids.ndbs);
+  writeObjectIds(out, leg.navaids.ils);
+  out << static_cast<qint32>(leg.navaids.runwayEnds.size());
+  for(const map::MapRunwayEnd& end : leg.navaids.runwayEnds)
+    writeRunwayEnd(out, end);
+
+  out << static_cast<qint32>(leg.altRestriction.descriptor) << leg.altRestriction.alt1 << leg.altRestriction.alt2
+      << static_cast<qint32>(leg.speedRestriction.descriptor) << leg.speedRestriction.speed
+      << static_cast<qint32>(leg.type) << static_cast<qint32>(leg.mapType)
+      << static_cast<qint32>(leg.approachId) << static_cast<qint32>(leg.transitionId)
+      << static_cast<qint32>(leg.legId) << static_cast<qint32>(leg.navId) << static_cast<qint32>(leg.recNavId)
+      << leg.course << leg.distance << leg.calculatedDistance << leg.calculatedTrueCourse
+      << leg.time << leg.theta << leg.rho << leg.magvar
+      << leg.missed << leg.flyover << leg.trueCourse << leg.intercept << leg.disabled;
+}
+
+void readLeg(QDataStream& in, MapProcedureLeg& leg, MapQuery *mapQuery)
+{
+  in >> leg.fixType >> leg.fixIdent >> leg.fixRegion
+  >> leg.recFixType >> leg.recFixIdent >> leg.recFixRegion
+  >> leg.turnDirection >> leg.arincDescrCode
+  >> leg.displayText >> leg.remarks
+  >> leg.fixPos >> leg.recFixPos >> leg.interceptPos >> leg.procedureTurnPos;
+
+  readLine(in, leg.line);
+  readLine(in, leg.holdLine);
+  readLineString(in, leg.geometry);
+
+  readObjectIds(in, leg.navaids, map::AIRPORT, mapQuery);
+  readObjectIds(in, leg.navaids, map::WAYPOINT, mapQuery);
+  readObjectIds(in, leg.navaids, map::VOR, mapQuery);
+  readObjectIds(in, leg.navaids, map::NDB, mapQuery);
+  readObjectIds(in, leg.navaids, map::ILS, mapQuery);
+  qint32 numRunwayEnds;
+  in >> numRunwayEnds;
+  for(qint32 i = 0; i < numRunwayEnds; i++)
+  {
+    map::MapRunwayEnd end;
+    readRunwayEnd(in, end);
+    leg.navaids.runwayEnds.append(end);
+  }
+
+  qint32 altDescriptor, speedDescriptor, type, mapType, approachId, transitionId, legId, navId, recNavId;
+  in >> altDescriptor >> leg.altRestriction.alt1 >> leg.altRestriction.alt2
+  >> speedDescriptor >> leg.speedRestriction.speed
+  >> type >> mapType
+  >> approachId >> transitionId >> legId >> navId >> recNavId
+  >> leg.course >> leg.distance >> leg.calculatedDistance >> leg.calculatedTrueCourse
+  >> leg.time >> leg.theta >> leg.rho >> leg.magvar
+  >> leg.missed >> leg.flyover >> leg.trueCourse >> leg.intercept >> leg.disabled;
+
+  leg.altRestriction.descriptor = static_cast<proc::MapAltRestriction::Descriptor>(altDescriptor);
+  leg.speedRestriction.descriptor = static_cast<proc::MapSpeedRestriction::Descriptor>(speedDescriptor);
+  leg.type = static_cast<proc::ProcedureLegType>(type);
+  leg.mapType = static_cast<proc::MapProcedureTypes>(mapType);
+  leg.approachId = approachId;
+  leg.transitionId = transitionId;
+  leg.legId = legId;
+  leg.navId = navId;
+  leg.recNavId = recNavId;
+}
+
+QByteArray writeLegs(const MapProcedureLegs& legs)
+{
+  QByteArray bytes;
+  QDataStream out(&bytes, QIODevice::WriteOnly);
+  out.setVersion(STREAM_VERSION);
+  out.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+  out << static_cast<qint32>(legs.approachLegs.size());
+  for(const MapProcedureLeg& leg : legs.approachLegs)
+    writeLeg(out, leg);
+
+  out << static_cast<qint32>(legs.transitionLegs.size());
+  for(const MapProcedureLeg& leg : legs.transitionLegs)
+    writeLeg(out, leg);
+
+  out << static_cast<qint32>(legs.ref.airportId) << static_cast<qint32>(legs.ref.runwayEndId)
+      << static_cast<qint32>(legs.ref.approachId) << static_cast<qint32>(legs.ref.transitionId)
+      << static_cast<qint32>(legs.ref.legId) << static_cast<qint32>(legs.ref.mapType);
+
+  out << legs.bounding.isValid();
+  if(legs.bounding.isValid())
+    out << legs.bounding.getWest() << legs.bounding.getNorth() << legs.bounding.getEast() << legs.bounding.getSouth();
+
+  out << legs.approachType << legs.approachSuffix << legs.approachFixIdent << legs.approachArincName
+      << legs.transitionType << legs.transitionFixIdent << legs.procedureRunway;
+  writeRunwayEnd(out, legs.runwayEnd);
+
+  out << static_cast<qint32>(legs.mapType)
+      << legs.approachDistance << legs.transitionDistance << legs.missedDistance
+      << legs.gpsOverlay << legs.hasError << legs.circleToLand;
+
+  return qCompress(bytes);
+}
+
+bool readLegs(const QByteArray& compressed, MapProcedureLegs& legs, MapQuery *mapQuery)
+{
+  QByteArray bytes = qUncompress(compressed);
+  QDataStream in(bytes);
+  in.setVersion(STREAM_VERSION);
+  in.setFloatingPointPrecision(QDataStream::SinglePrecision);
+
+  qint32 size;
+  in >> size;
+  for(qint32 i = 0; i < size; i++)
+  {
+    MapProcedureLeg leg;
+    readLeg(in, leg, mapQuery);
+    legs.approachLegs.append(leg);
+  }
+
+  in >> size;
+  for(qint32 i = 0; i < size; i++)
+  {
+    MapProcedureLeg leg;
+    readLeg(in, leg, mapQuery);
+    legs.transitionLegs.append(leg);
+  }
+
+  qint32 airportId, runwayEndId, approachId, transitionId, legId, refMapType;
+  in >> airportId >> runwayEndId >> approachId >> transitionId >> legId >> refMapType;
+  legs.ref = proc::MapProcedureRef(airportId, runwayEndId, approachId, transitionId, legId,
+                                   static_cast<proc::MapProcedureTypes>(refMapType));
+
+  bool boundingValid;
+  in >> boundingValid;
+  if(boundingValid)
+  {
+    float west, north, east, south;
+    in >> west >> north >> east >> south;
+    legs.bounding = Rect(west, north, east, south);
+  }
+
+  in >> legs.approachType >> legs.approachSuffix >> legs.approachFixIdent >> legs.approachArincName
+  >> legs.transitionType >> legs.transitionFixIdent >> legs.procedureRunway;
+  readRunwayEnd(in, legs.runwayEnd);
+
+  qint32 mapType;
+  in >> mapType
+  >> legs.approachDistance >> legs.transitionDistance >> legs.missedDistance
+  >> legs.gpsOverlay >> legs.hasError >> legs.circleToLand;
+  legs.mapType = static_cast<proc::MapProcedureTypes>(mapType);
+
+  return in.status() == QDataStream::Ok;
+}
+
+}
+
+// ==========================================================================================
+ProcedureCache::ProcedureCache()
+{
+
+}
+
+ProcedureCache::~ProcedureCache()
+{
+  close();
+}
+
+QString ProcedureCache::cacheFileName(const QString& sourceFile)
+{
+  return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QDir::separator() +
+         QFileInfo(sourceFile).completeBaseName() + ".proccache";
+}
+
+bool ProcedureCache::merge(const QVector<ProcedureCacheWriter *>& parts, const QString& sourceFile,
+                           const QString& cacheFile, const QString& key)
+{
+  QElapsedTimer timer;
+  timer.start();
+
+  // Build global index with offsets relative to the start of the record section
+  QVector<IndexEntry> globalIndex;
+  qint64 offset = 0;
+  for(const ProcedureCacheWriter *part : parts)
+  {
+    for(IndexEntry entry : part->getIndex())
+    {
+      entry.offset += offset;
+      globalIndex.append(entry);
+    }
+    offset += QFileInfo(part->getFileName()).size();
+  }
+  std::sort(globalIndex.begin(), globalIndex.end(), indexLessThan);
+
+  QFileInfo sourceInfo(sourceFile);
+  CacheHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+  header.version = CACHE_VERSION;
+  header.byteOrder = CACHE_BYTE_ORDER;
+  header.sourceSize = sourceInfo.size();
+  header.sourceModified = sourceInfo.lastModified().toMSecsSinceEpoch();
+  QByteArray keyBytes = key.toUtf8().left(KEY_SIZE - 1);
+  std::memcpy(header.key, keyBytes.constData(), static_cast<size_t>(keyBytes.size()));
+  header.numRecords = static_cast<quint32>(globalIndex.size());
+
+  // Write to temporary file and rename when done
+  QDir().mkpath(QFileInfo(cacheFile).absolutePath());
+  QString tempFile = cacheFile + ".tmp";
+  QFile file(tempFile);
+  if(!file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+  {
+    qWarning() << Q_FUNC_INFO << "Cannot open" << tempFile << file.errorString();
+    return false;
+  }
+
+  qint64 indexSize = globalIndex.size() * static_cast<qint64>(sizeof(IndexEntry));
+  bool ok = file.write(reinterpret_cast<const char *>(&header), sizeof(header)) == sizeof(header);
+  ok &= file.write(reinterpret_cast<const char *>(globalIndex.constData()), indexSize) == indexSize;
+
+  // Append part files in order
+  for(const ProcedureCacheWriter *part : parts)
+  {
+    QFile partFile(part->getFileName());
+    if(ok && partFile.open(QIODevice::ReadOnly))
+    {
+      while(ok && !partFile.atEnd())
+      {
+        QByteArray buffer = partFile.read(1024 * 1024);
+        ok &= file.write(buffer) == buffer.size();
+      }
+      partFile.close();
+    }
+    else
+      ok = false;
+    QFile::remove(part->getFileName());
+  }
+  file.close();
+
+  if(!ok)
+  {
+    qWarning() << Q_FUNC_INFO << "Writing" << tempFile << "failed" << file.errorString();
+    QFile::remove(tempFile);
+    return false;
+  }
+
+  QFile::remove(cacheFile);
+  if(!QFile::rename(tempFile, cacheFile))
+  {
+    qWarning() << Q_FUNC_INFO << "Renaming" << tempFile << "to" << cacheFile << "failed";
+    QFile::remove(tempFile);
+    return false;
+  }
+
+  qInfo() << Q_FUNC_INFO << "Wrote" << globalIndex.size() << "procedures to" << cacheFile
+          << "size" << QFileInfo(cacheFile).size() / 1024 << "kB in" << timer.elapsed() << "ms";
+  return true;
+}
+
+bool ProcedureCache::isValidFor(const QString& sourceFile, const QString& cacheFile, const QString& key)
+{
+  CacheHeader header;
+  return readHeader(cacheFile, header) && isHeaderValid(header, sourceFile, key);
+}
+
+bool ProcedureCache::open(const QString& sourceFile, const QString& cacheFile, const QString& key)
+{
+  close();
+
+  file.setFileName(cacheFile);
+  if(!file.open(QIODevice::ReadOnly))
+    return false;
+
+  qint64 size = file.size();
+  if(size >= static_cast<qint64>(sizeof(CacheHeader)))
+  {
+    const uchar *mapped = file.map(0, size);
+    if(mapped != nullptr)
+    {
+      const CacheHeader *header = reinterpret_cast<const CacheHeader *>(mapped);
+      qint64 recordsOffset = static_cast<qint64>(sizeof(CacheHeader)) +
+                             static_cast<qint64>(header->numRecords) * static_cast<qint64>(sizeof(IndexEntry));
+
+      if(isHeaderValid(*header, sourceFile, key) && size >= recordsOffset)
+      {
+        data = mapped;
+        dataSize = size;
+        index = reinterpret_cast<const IndexEntry *>(mapped + sizeof(CacheHeader));
+        records = mapped + recordsOffset;
+        numRecords = header->numRecords;
+
+        qInfo() << Q_FUNC_INFO << "Opened" << cacheFile << "with" << numRecords << "procedures";
+        return true;
+      }
+      file.unmap(const_cast<uchar *>(mapped));
+    }
+  }
+
+  qWarning() << Q_FUNC_INFO << "Procedure cache" << cacheFile << "is not valid";
+  file.close();
+  return false;
+}
+
+void ProcedureCache::close()
+{
+  if(data != nullptr)
+    file.unmap(const_cast<uchar *>(data));
+
+  data = nullptr;
+  dataSize = 0;
+  index = nullptr;
+  records = nullptr;
+  numRecords = 0;
+
+  if(file.isOpen())
+    file.close();
+}
+
+bool ProcedureCache::getLegs(Kind kind, int id, proc::MapProcedureLegs& legs, MapQuery *mapQuery) const
+{
+  if(!isOpen())
+    return false;
+
+  IndexEntry search;
+  search.kind = kind;
+  search.id = id;
+
+  const IndexEntry *end = index + numRecords;
+  const IndexEntry *entry = std::lower_bound(index, end, search, indexLessThan);
+  if(entry == end || entry->kind != static_cast<quint32>(kind) || entry->id != id)
+    return false;
+
+  if(records + entry->offset + entry->size > data + dataSize)
+  {
+    qWarning() << Q_FUNC_INFO << "Invalid record for" << kind << id;
+    return false;
+  }
+
+  // Copy since qUncompress needs a byte array
+  QByteArray compressed(reinterpret_cast<const char *>(records + entry->offset), static_cast<int>(entry->size));
+  return readLegs(compressed, legs, mapQuery);
+}
+
+// ==========================================================================================
+ProcedureCacheWriter::ProcedureCacheWriter(const QString& partFile)
+  : file(partFile)
+{
+
+}
+
+ProcedureCacheWriter::~ProcedureCacheWriter()
+{
+  close();
+}
+
+bool ProcedureCacheWriter::open()
+{
+  QDir().mkpath(QFileInfo(file.fileName()).absolutePath());
+  index.clear();
+  offset = 0;
+  return file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+}
+
+bool ProcedureCacheWriter::add(ProcedureCache::Kind kind, int id, const proc::MapProcedureLegs& legs)
+{
+  QByteArray bytes = writeLegs(legs);
+  if(file.write(bytes) != bytes.size())
+    return false;
+
+  ProcedureCache::IndexEntry entry;
+  entry.kind = kind;
+  entry.id = id;
+  entry.offset = offset;
+  entry.size = static_cast<quint32>(bytes.size());
+  entry.reserved = 0;
+  index.append(entry);
+
+  offset += bytes.size();
+  return true;
+}
+
+void ProcedureCacheWriter::close()
+{
+  if(file.isOpen())
+    file.close();
+}
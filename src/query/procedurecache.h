@@ -0,0 +1,136 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLENAVMAP_PROCEDURECACHE_H
+#define LITTLENAVMAP_PROCEDURECACHE_H
+
+#include <QFile>
+#include <QVector>
+
+namespace proc {
+struct MapProcedureLegs;
+}
+
+class MapQuery;
+class ProcedureCacheWriter;
+
+/*
+ * Read-only file cache of fully processed approaches and transitions of the navdata database.
+ *
+ * The file is built in parts by worker threads after a database load and memory mapped.
+ * It contains a header, an index of records sorted by kind and procedure ID and compressed records
+ * each containing one serialized MapProcedureLegs object.
+ *
+ * The header keeps size and modification time of the source database as well as a key which contains
+ * AIRAC cycle and unit settings since leg texts contain formatted distances. The key also contains a hash
+ * identifying the simulator database version since ILS are resolved from it.
+ * A cache is only used if all these match. Byte order is native since the file is a local cache.
+ */
+class ProcedureCache
+{
+public:
+  enum Kind
+  {
+    APPROACH = 1,
+    TRANSITION = 2
+  };
+
+  /* Index entry for a record. Offset is relative to the start of the data section or the part file. */
+  struct IndexEntry
+  {
+    quint32 kind;
+    qint32 id;
+    qint64 offset;
+    quint32 size;
+    quint32 reserved;
+  };
+
+  ProcedureCache();
+  ~ProcedureCache();
+
+  /* Concatenate all parts into the cache file and delete the part files.
+   * Writes to a temporary file first and renames it on success. */
+  static bool merge(const QVector<ProcedureCacheWriter *>& parts, const QString& sourceFile,
+                    const QString& cacheFile, const QString& key);
+
+  /* true if the cache file exists, has the current version and matches the source database and key */
+  static bool isValidFor(const QString& sourceFile, const QString& cacheFile, const QString& key);
+
+  /* Cache file name in the cache directory for the given database file */
+  static QString cacheFileName(const QString& sourceFile);
+
+  /* Map file into memory. Returns false if the file is not valid for the source database and key. */
+  bool open(const QString& sourceFile, const QString& cacheFile, const QString& key);
+  void close();
+
+  bool isOpen() const
+  {
+    return data != nullptr;
+  }
+
+  /* Load legs from the cache. Navaids are resolved by ID using the given map query.
+   * Returns false if the procedure is not in the cache. */
+  bool getLegs(Kind kind, int id, proc::MapProcedureLegs& legs, MapQuery *mapQuery) const;
+
+  /* Number of approaches and transitions in the cache */
+  int size() const
+  {
+    return static_cast<int>(numRecords);
+  }
+
+private:
+  QFile file;
+  const uchar *data = nullptr;
+  qint64 dataSize = 0;
+
+  /* Pointers into mapped data */
+  const IndexEntry *index = nullptr;
+  const uchar *records = nullptr;
+  quint32 numRecords = 0;
+};
+
+/* Writes records for a part of the database into a temporary file. Used by one worker thread. */
+class ProcedureCacheWriter
+{
+public:
+  explicit ProcedureCacheWriter(const QString& partFile);
+  ~ProcedureCacheWriter();
+
+  bool open();
+
+  /* Serialize, compress and append legs */
+  bool add(ProcedureCache::Kind kind, int id, const proc::MapProcedureLegs& legs);
+
+  void close();
+
+  const QVector<ProcedureCache::IndexEntry>& getIndex() const
+  {
+    return index;
+  }
+
+  QString getFileName() const
+  {
+    return file.fileName();
+  }
+
+private:
+  QFile file;
+  QVector<ProcedureCache::IndexEntry> index;
+  qint64 offset = 0;
+};
+
+#endif // LITTLENAVMAP_PROCEDURECACHE_H
@@ -19,14 +19,25 @@
 #include "navapp.h"
 #include "query/mapquery.h"
 #include "query/airportquery.h"
+#include "query/procedurecache.h"
 #include "geo/calculations.h"
 #include "sql/sqldatabase.h"
 #include "common/unit.h"
 #include "common/constants.h"
 #include "geo/line.h"
 #include "fs/pln/flightplan.h"
+#include "db/databasepool.h"
+#include "route/route.h"
+#include "settings/settings.h"
 
 #include "sql/sqlquery.h"
+#include "sql/sqlutil.h"
+
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QLocale>
+#include <QtConcurrent/QtConcurrentRun>
 
 using atools::sql::SqlQuery;
 using atools::geo::Pos;
@@ -46,15 +57,50 @@ using proc::MapSpeedRestriction;
 namespace pln = atools::fs::pln;
 
 ProcedureQuery::ProcedureQuery(atools::sql::SqlDatabase *sqlDbNav)
-  : dbNav(sqlDbNav)
+  : ProcedureQuery(sqlDbNav, NavApp::getMapQuery(), NavApp::getAirportQueryNav(), readConfig())
+{
+  // Worker threads must not access the settings - read them here
+  workerConfig.airportQuery = AirportQuery::readConfig();
+  workerConfig.mapQuery = MapQuery::readConfig();
+  workerConfig.procedureQuery = readConfig();
+
+  // Persistent cache is only used by the GUI instance
+  procedureCacheEnabled = workerConfig.procedureQuery.procedureCacheFile;
+}
+
+ProcedureQuery::ProcedureQuery(atools::sql::SqlDatabase *sqlDbNav, MapQuery *mapQueryParam,
+                               AirportQuery *airportQueryNavParam, const Config& config)
+  : dbNav(sqlDbNav), prefetchCancel(false)
+{
+  mapQuery = mapQueryParam;
+  airportQueryNav = airportQueryNavParam;
+
+  approachCache.setMaxCost(config.procedureCacheKb);
+  transitionCache.setMaxCost(config.procedureCacheKb);
+
+  connect(&prefetchWatcher, &QFutureWatcher<PrefetchResult>::finished, this, &ProcedureQuery::prefetchFinished);
+
+  procedureCache = new ProcedureCache;
+  connect(&procedureCacheWatcher, &QFutureWatcher<bool>::finished, this, &ProcedureQuery::procedureCacheBuilt);
+
+  // Own pool to avoid blocking other background tasks in the global pool for the long build
+  procedureCachePool.setMaxThreadCount(PROCEDURE_CACHE_THREADS);
+}
+
+ProcedureQuery::Config ProcedureQuery::readConfig()
 {
-  mapQuery = NavApp::getMapQuery();
-  airportQueryNav = NavApp::getAirportQueryNav();
+  atools::settings::Settings& settings = atools::settings::Settings::instance();
+
+  Config config;
+  config.procedureCacheKb = settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY + "ProcedureCacheKb", 20000).toInt();
+  config.procedureCacheFile = settings.getAndStoreValue(lnm::SETTINGS_MAPQUERY + "ProcedureCacheFile", true).toBool();
+  return config;
 }
 
 ProcedureQuery::~ProcedureQuery()
 {
   deInitQueries();
+  delete procedureCache;
 }
 
 const proc::MapProcedureLegs *ProcedureQuery::getApproachLegs(map::MapAirport airport, int approachId)
@@ -536,6 +582,13 @@ proc::MapProcedureLegs *ProcedureQuery::fetchApproachLegs(const map::MapAirport&
 #ifndef DEBUG_APPROACH_NO_CACHE
   if(approachCache.contains(approachId))
     return approachCache.object(approachId);
+
+  MapProcedureLegs *cachedLegs = fetchCachedLegs(false /* transition */, approachId);
+  if(cachedLegs != nullptr)
+  {
+    insertApproach(approachId, cachedLegs);
+    return cachedLegs;
+  }
   else
 #endif
   {
@@ -544,10 +597,7 @@ proc::MapProcedureLegs *ProcedureQuery::fetchApproachLegs(const map::MapAirport&
     MapProcedureLegs *legs = buildApproachLegs(airport, approachId);
     postProcessLegs(airport, *legs, true /*addArtificialLegs*/);
 
-    for(int i = 0; i < legs->size(); i++)
-      approachLegIndex.insert(legs->at(i).legId, std::make_pair(approachId, i));
-
-    approachCache.insert(approachId, legs);
+    insertApproach(approachId, legs);
     return legs;
   }
 }
@@ -560,6 +610,13 @@ proc::MapProcedureLegs *ProcedureQuery::fetchTransitionLegs(const map::MapAirpor
 #ifndef DEBUG_APPROACH_NO_CACHE
   if(transitionCache.contains(transitionId))
     return transitionCache.object(transitionId);
+
+  MapProcedureLegs *cachedLegs = fetchCachedLegs(true /* transition */, transitionId);
+  if(cachedLegs != nullptr)
+  {
+    insertTransition(transitionId, cachedLegs);
+    return cachedLegs;
+  }
   else
 #endif
   {
@@ -606,12 +663,448 @@ proc::MapProcedureLegs *ProcedureQuery::fetchTransitionLegs(const map::MapAirpor
 
     postProcessLegs(airport, *legs, true /*addArtificialLegs*/);
 
-    for(int i = 0; i < legs->size(); ++i)
-      transitionLegIndex.insert(legs->at(i).legId, std::make_pair(transitionId, i));
+    insertTransition(transitionId, legs);
+    return legs;
+  }
+}
+
+void ProcedureQuery::insertApproach(int approachId, proc::MapProcedureLegs *legs)
+{
+  for(int i = 0; i < legs->size(); i++)
+    approachLegIndex.insert(legs->at(i).legId, std::make_pair(approachId, i));
+
+  // Legs are always returned to the caller - keep in cache even if larger than the budget
+  approachCache.insert(approachId, legs, std::min(procedureCost(*legs), approachCache.maxCost()));
+}
+
+void ProcedureQuery::insertTransition(int transitionId, proc::MapProcedureLegs *legs)
+{
+  for(int i = 0; i < legs->size(); ++i)
+    transitionLegIndex.insert(legs->at(i).legId, std::make_pair(transitionId, i));
+
+  transitionCache.insert(transitionId, legs, std::min(procedureCost(*legs), transitionCache.maxCost()));
+}
+
+int ProcedureQuery::procedureCost(const proc::MapProcedureLegs& legs)
+{
+  size_t bytes = sizeof(proc::MapProcedureLegs);
+  for(int i = 0; i < legs.size(); i++)
+  {
+    const MapProcedureLeg& leg = legs.at(i);
+    bytes += sizeof(MapProcedureLeg) + static_cast<size_t>(leg.geometry.size()) * sizeof(Pos);
+
+    for(const QString& str : leg.displayText)
+      bytes += static_cast<size_t>(str.size()) * sizeof(QChar);
+    for(const QString& str : leg.remarks)
+      bytes += static_cast<size_t>(str.size()) * sizeof(QChar);
+  }
+  return std::max(1, static_cast<int>(bytes / 1024));
+}
+
+void ProcedureQuery::routeChanged(bool geometryChanged)
+{
+  if(!geometryChanged || NavApp::isLoadingDatabase())
+    return;
+
+  const Route& route = NavApp::getRouteConst();
+  QList<map::MapAirport> airports;
+  QVector<int> airportIds;
+  if(route.hasValidDeparture())
+  {
+    airports.append(route.first().getAirport());
+    airportIds.append(airports.last().id);
+  }
+  if(route.hasValidDestination())
+  {
+    airports.append(route.last().getAirport());
+    airportIds.append(airports.last().id);
+  }
+
+  if(airportIds == prefetchAirportIds)
+    // Departure and destination not changed - procedures are already loaded or being loaded
+    return;
+
+  if(!airports.isEmpty() && !procedureCache->isOpen())
+    // Not needed if all procedures can be loaded from the persistent cache
+    prefetchProcedures(airports);
+}
+
+void ProcedureQuery::prefetchProcedures(const QList<map::MapAirport>& airports)
+{
+  if(approachLegQuery == nullptr || NavApp::getDatabasePool() == nullptr)
+    // Not initialized
+    return;
+
+  cancelPrefetch();
+  prefetchCancel = false;
+  prefetchFuture = QtConcurrent::run(this, &ProcedureQuery::prefetchProceduresThread, airports);
+  prefetchWatcher.setFuture(prefetchFuture);
+
+  for(const map::MapAirport& airport : airports)
+    prefetchAirportIds.append(airport.id);
+}
+
+ProcedureQuery::PrefetchResult ProcedureQuery::prefetchProceduresThread(QList<map::MapAirport> airports)
+{
+  PrefetchResult result;
+  DatabasePool *pool = NavApp::getDatabasePool();
+
+  try
+  {
+    atools::sql::SqlDatabase *poolDbSim = pool->getDatabase(dbpool::SIM);
+    atools::sql::SqlDatabase *poolDbNav = pool->getDatabase(dbpool::NAV);
+
+    if(poolDbSim != nullptr && poolDbNav != nullptr)
+    {
+      // Own query objects for this thread - no user database needed. Use settings read in the GUI thread.
+      AirportQuery airportQuerySimWorker(nullptr, poolDbSim, false /* nav */, workerConfig.airportQuery);
+      airportQuerySimWorker.initQueries();
+
+      AirportQuery airportQueryNavWorker(nullptr, poolDbNav, true /* nav */, workerConfig.airportQuery);
+      airportQueryNavWorker.initQueries();
+
+      MapQuery mapQueryWorker(nullptr, poolDbSim, poolDbNav, nullptr, workerConfig.mapQuery);
+      mapQueryWorker.setAirportQueries(&airportQuerySimWorker, &airportQueryNavWorker);
+      mapQueryWorker.initQueries();
+
+      ProcedureQuery procQuery(poolDbNav, &mapQueryWorker, &airportQueryNavWorker, workerConfig.procedureQuery);
+      procQuery.initQueries();
+
+      for(map::MapAirport airport : airports)
+      {
+        if(prefetchCancel)
+          break;
+
+        mapQueryWorker.getAirportNavReplace(airport);
+        procQuery.buildAllProcedures(airport, result);
+      }
+
+      procQuery.deInitQueries();
+      mapQueryWorker.deInitQueries();
+      airportQueryNavWorker.deInitQueries();
+      airportQuerySimWorker.deInitQueries();
+    }
+  }
+  catch(std::exception& e)
+  {
+    // Prefetching is optional - procedures are loaded on demand later
+    qWarning() << Q_FUNC_INFO << "Prefetching procedures failed" << e.what();
+    result = PrefetchResult();
+  }
+
+  pool->releaseThread();
+  return result;
+}
+
+void ProcedureQuery::buildAllProcedures(const map::MapAirport& airport, PrefetchResult& result)
+{
+  QVector<int> approachIds;
+  approachIdsForAirportQuery->bindValue(":id", airport.id);
+  approachIdsForAirportQuery->exec();
+  while(approachIdsForAirportQuery->next())
+    approachIds.append(approachIdsForAirportQuery->value("approach_id").toInt());
+  approachIdsForAirportQuery->finish();
+
+  for(int approachId : approachIds)
+  {
+    if(prefetchCancel)
+      return;
+
+    // Copy since the objects can be evicted from the cache of this query object
+    const MapProcedureLegs *legs = fetchApproachLegs(airport, approachId);
+    if(legs != nullptr)
+      result.approaches.insert(approachId, *legs);
+
+    for(int transitionId : getTransitionIdsForApproach(approachId))
+    {
+      legs = fetchTransitionLegs(airport, approachId, transitionId);
+      if(legs != nullptr)
+        result.transitions.insert(transitionId, *legs);
+    }
+  }
+}
+
+void ProcedureQuery::prefetchFinished()
+{
+  if(prefetchCancel || approachLegQuery == nullptr || !prefetchFuture.isFinished())
+    // Canceled, database was switched or signal of a previous prefetch which arrived after restarting
+    return;
+
+  const PrefetchResult& result = prefetchFuture.result();
+
+  for(auto it = result.approaches.constBegin(); it != result.approaches.constEnd(); ++it)
+  {
+    if(!approachCache.contains(it.key()))
+      insertApproach(it.key(), new MapProcedureLegs(it.value()));
+  }
+
+  for(auto it = result.transitions.constBegin(); it != result.transitions.constEnd(); ++it)
+  {
+    if(!transitionCache.contains(it.key()))
+      insertTransition(it.key(), new MapProcedureLegs(it.value()));
+  }
+
+  qDebug() << Q_FUNC_INFO << "Prefetched" << result.approaches.size() << "approaches and"
+           << result.transitions.size() << "transitions";
 
-    transitionCache.insert(transitionId, legs);
+  prefetchFuture = QFuture<PrefetchResult>();
+}
+
+void ProcedureQuery::cancelPrefetch()
+{
+  // Set always since a finished signal might still be queued - this drops its result
+  prefetchCancel = true;
+  if(prefetchFuture.isRunning())
+    prefetchFuture.waitForFinished();
+  prefetchFuture = QFuture<PrefetchResult>();
+
+  // Results are dropped - load again on next route change
+  prefetchAirportIds.clear();
+}
+
+proc::MapProcedureLegs *ProcedureQuery::fetchCachedLegs(bool transition, int id)
+{
+  if(!procedureCache->isOpen())
+    return nullptr;
+
+  MapProcedureLegs *legs = new MapProcedureLegs;
+  if(procedureCache->getLegs(transition ? ProcedureCache::TRANSITION : ProcedureCache::APPROACH, id, *legs,
+                             mapQuery))
     return legs;
+
+  delete legs;
+  return nullptr;
+}
+
+QString ProcedureQuery::procedureCacheKey()
+{
+  // ILS are resolved from the simulator database which can change independently of the navdata database.
+  // Add a hash of its name, size and modification time since IDs, positions and magvar are stored in the legs.
+  QFileInfo simInfo(NavApp::getDatabaseSim()->databaseName());
+  QString simId = QString("%1|%2|%3").arg(simInfo.absoluteFilePath()).arg(simInfo.size()).
+                  arg(simInfo.lastModified().toMSecsSinceEpoch());
+  QString simHash = QCryptographicHash::hash(simId.toUtf8(), QCryptographicHash::Md5).toHex();
+
+  // Leg texts contain formatted distances
+  return NavApp::getDatabaseAiracCycleNav() + "|" + Unit::distNm(1.5f, true, 20, true) + "|" + QLocale().name() +
+         "|" + simHash;
+}
+
+void ProcedureQuery::startProcedureCache()
+{
+  if(!procedureCacheEnabled || procedureCacheBuilding || NavApp::getDatabasePool() == nullptr)
+    return;
+
+  procedureCacheSourceFile = dbNav->databaseName();
+  procedureCacheFile = ProcedureCache::cacheFileName(procedureCacheSourceFile);
+  procedureCacheKeyStr = procedureCacheKey();
+
+  if(ProcedureCache::isValidFor(procedureCacheSourceFile, procedureCacheFile, procedureCacheKeyStr))
+    procedureCache->open(procedureCacheSourceFile, procedureCacheFile, procedureCacheKeyStr);
+  else
+    buildProcedureCache();
+}
+
+void ProcedureQuery::buildProcedureCache()
+{
+  // Get all airports having procedures - simple query which can run in the GUI thread
+  QVector<int> airportIds;
+  if(atools::sql::SqlUtil(dbNav).hasTable("approach"))
+  {
+    SqlQuery query(dbNav);
+    query.exec("select distinct airport_id from approach order by airport_id");
+    while(query.next())
+      airportIds.append(query.value(0).toInt());
+  }
+
+  if(airportIds.isEmpty())
+    return;
+
+  // Build in background - procedures are built on demand until the file is ready
+  qDebug() << Q_FUNC_INFO << "Building" << procedureCacheFile;
+  procedureCacheCancel = false;
+  procedureCacheBuilding = true;
+  procedureCacheMerging = false;
+  procedureCachePartsSuccess = true;
+  procedureCacheNumAirports = airportIds.size();
+  procedureCacheTimer.start();
+
+  int numParts = std::min(procedureCachePool.maxThreadCount(), airportIds.size());
+  procedureCachePartsRunning = numParts;
+  for(int i = 0; i < numParts; i++)
+  {
+    // Interleave airports to spread airports with many procedures evenly across parts
+    QVector<int> partAirportIds;
+    for(int j = i; j < airportIds.size(); j += numParts)
+      partAirportIds.append(airportIds.at(j));
+
+    ProcedureCacheWriter *writer = new ProcedureCacheWriter(procedureCacheFile + QString(".part%1").arg(i));
+    procedureCacheWriters.append(writer);
+
+    QFutureWatcher<bool> *watcher = new QFutureWatcher<bool>(this);
+    connect(watcher, &QFutureWatcher<bool>::finished, this, [this, watcher]()
+    {
+      procedureCachePartFinished(watcher->result());
+    });
+    procedureCachePartWatchers.append(watcher);
+
+    watcher->setFuture(QtConcurrent::run(&procedureCachePool, this, &ProcedureQuery::buildProcedureCachePart,
+                                         partAirportIds, writer));
+  }
+}
+
+void ProcedureQuery::procedureCachePartFinished(bool success)
+{
+  if(!procedureCacheBuilding)
+    // Already stopped by deInitQueries
+    return;
+
+  procedureCachePartsSuccess &= success;
+  if(--procedureCachePartsRunning > 0)
+    // Wait for other parts
+    return;
+
+  if(!procedureCachePartsSuccess || procedureCacheCancel)
+  {
+    qWarning() << Q_FUNC_INFO << "Building procedure cache failed or cancelled";
+    deleteProcedureCacheParts();
+    procedureCacheBuilding = false;
+    return;
   }
+
+  // All parts done - concatenate files in background
+  procedureCacheMerging = true;
+  procedureCacheFuture = QtConcurrent::run(&procedureCachePool, this, &ProcedureQuery::mergeProcedureCache,
+                                           procedureCacheSourceFile, procedureCacheFile, procedureCacheKeyStr);
+  procedureCacheWatcher.setFuture(procedureCacheFuture);
+}
+
+bool ProcedureQuery::mergeProcedureCache(QString sourceFile, QString cacheFile, QString key)
+{
+  // Writers are not touched by the GUI thread while merging
+  return !procedureCacheCancel && ProcedureCache::merge(procedureCacheWriters, sourceFile, cacheFile, key);
+}
+
+void ProcedureQuery::procedureCacheBuilt()
+{
+  if(!procedureCacheBuilding || !procedureCacheMerging)
+    // Already stopped by deInitQueries
+    return;
+
+  bool success = procedureCacheFuture.result();
+  qInfo() << Q_FUNC_INFO << "Procedure cache for" << procedureCacheNumAirports << "airports"
+          << (success ? "built" : "failed or cancelled") << "in" << procedureCacheTimer.elapsed() << "ms";
+
+  deleteProcedureCacheParts();
+  procedureCacheBuilding = false;
+  procedureCacheMerging = false;
+
+  if(success && procedureCacheSourceFile == dbNav->databaseName())
+    procedureCache->open(procedureCacheSourceFile, procedureCacheFile, procedureCacheKeyStr);
+}
+
+void ProcedureQuery::stopProcedureCache()
+{
+  if(procedureCacheBuilding)
+  {
+    // Pooled connections are closed after this - stop all parts and merging first
+    procedureCacheCancel = true;
+    procedureCachePool.waitForDone();
+    deleteProcedureCacheParts();
+    procedureCacheBuilding = false;
+    procedureCacheMerging = false;
+  }
+  procedureCache->close();
+}
+
+void ProcedureQuery::deleteProcedureCacheParts()
+{
+  // Might be called from a finished signal of a watcher - disconnect to drop pending signals
+  for(QFutureWatcher<bool> *watcher : procedureCachePartWatchers)
+  {
+    watcher->disconnect();
+    watcher->deleteLater();
+  }
+  procedureCachePartWatchers.clear();
+
+  // Remove files which are left over if merging was not done
+  for(ProcedureCacheWriter *writer : procedureCacheWriters)
+    QFile::remove(writer->getFileName());
+  qDeleteAll(procedureCacheWriters);
+  procedureCacheWriters.clear();
+}
+
+bool ProcedureQuery::buildProcedureCachePart(QVector<int> airportIds, ProcedureCacheWriter *writer)
+{
+  DatabasePool *pool = NavApp::getDatabasePool();
+  bool success = false;
+
+  try
+  {
+    atools::sql::SqlDatabase *poolDbSim = pool->getDatabase(dbpool::SIM);
+    atools::sql::SqlDatabase *poolDbNav = pool->getDatabase(dbpool::NAV);
+
+    if(poolDbSim != nullptr && poolDbNav != nullptr && writer->open())
+    {
+      // Own query objects for this thread - no user database needed. Use settings read in the GUI thread.
+      AirportQuery airportQuerySimWorker(nullptr, poolDbSim, false /* nav */, workerConfig.airportQuery);
+      airportQuerySimWorker.initQueries();
+
+      AirportQuery airportQueryNavWorker(nullptr, poolDbNav, true /* nav */, workerConfig.airportQuery);
+      airportQueryNavWorker.initQueries();
+
+      MapQuery mapQueryWorker(nullptr, poolDbSim, poolDbNav, nullptr, workerConfig.mapQuery);
+      mapQueryWorker.setAirportQueries(&airportQuerySimWorker, &airportQueryNavWorker);
+      mapQueryWorker.initQueries();
+
+      ProcedureQuery procQuery(poolDbNav, &mapQueryWorker, &airportQueryNavWorker, workerConfig.procedureQuery);
+      procQuery.initQueries();
+
+      success = true;
+      for(int airportId : airportIds)
+      {
+        if(procedureCacheCancel)
+        {
+          success = false;
+          break;
+        }
+
+        map::MapAirport airport = airportQueryNavWorker.getAirportById(airportId);
+        if(!airport.isValid())
+          continue;
+
+        PrefetchResult result;
+        procQuery.buildAllProcedures(airport, result);
+
+        for(auto it = result.approaches.constBegin(); it != result.approaches.constEnd() && success; ++it)
+          success &= writer->add(ProcedureCache::APPROACH, it.key(), it.value());
+
+        for(auto it = result.transitions.constBegin(); it != result.transitions.constEnd() && success; ++it)
+          success &= writer->add(ProcedureCache::TRANSITION, it.key(), it.value());
+
+        if(!success)
+        {
+          qWarning() << Q_FUNC_INFO << "Writing" << writer->getFileName() << "failed";
+          break;
+        }
+      }
+
+      procQuery.deInitQueries();
+      mapQueryWorker.deInitQueries();
+      airportQueryNavWorker.deInitQueries();
+      airportQuerySimWorker.deInitQueries();
+    }
+  }
+  catch(std::exception& e)
+  {
+    // Procedures are built on demand if the cache is not available
+    qWarning() << Q_FUNC_INFO << "Building procedure cache failed" << e.what();
+    success = false;
+  }
+
+  writer->close();
+  pool->releaseThread();
+  return success;
 }
 
 proc::MapProcedureLegs *ProcedureQuery::buildApproachLegs(const map::MapAirport& airport, int approachId)
@@ -1480,10 +1973,19 @@ void ProcedureQuery::initQueries()
 
   transitionIdsForApproachQuery = new SqlQuery(dbNav);
   transitionIdsForApproachQuery->prepare("select transition_id from transition where approach_id = :id");
+
+  approachIdsForAirportQuery = new SqlQuery(dbNav);
+  approachIdsForAirportQuery->prepare("select approach_id from approach where airport_id = :id");
+
+  startProcedureCache();
 }
 
 void ProcedureQuery::deInitQueries()
 {
+  // Workers use pooled connections which are closed on database switch
+  cancelPrefetch();
+  stopProcedureCache();
+
   approachCache.clear();
   transitionCache.clear();
   approachLegIndex.clear();
@@ -1521,6 +2023,9 @@ void ProcedureQuery::deInitQueries()
 
   delete transitionIdsForApproachQuery;
   transitionIdsForApproachQuery = nullptr;
+
+  delete approachIdsForAirportQuery;
+  approachIdsForAirportQuery = nullptr;
 }
 
 void ProcedureQuery::clearFlightplanProcedureProperties(QHash<QString, QString>& properties,
@@ -1723,10 +2228,20 @@ void ProcedureQuery::clearCache()
 {
   qDebug() << Q_FUNC_INFO;
 
+  // Prefetched legs might use old units
+  cancelPrefetch();
+
   approachCache.clear();
   transitionCache.clear();
   approachLegIndex.clear();
   transitionLegIndex.clear();
+
+  // Reopen persistent cache which is rebuilt if the units have changed
+  if(procedureCacheEnabled && approachLegQuery != nullptr && procedureCacheKey() != procedureCacheKeyStr)
+  {
+    stopProcedureCache();
+    startProcedureCache();
+  }
 }
 
 QVector<int> ProcedureQuery::getTransitionIdsForApproach(int approachId)
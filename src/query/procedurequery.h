@@ -21,10 +21,16 @@
 #include "geo/pos.h"
 #include "common/proctypes.h"
 #include "fs/fspaths.h"
+#include "query/airportquery.h"
+#include "query/mapquery.h"
 
 #include <QCache>
 #include <QApplication>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+#include <QThreadPool>
 #include <functional>
+#include <atomic>
 
 namespace atools {
 namespace sql {
@@ -33,14 +39,17 @@ class SqlQuery;
 }
 }
 
-class MapQuery;
-class AirportQuery;
+class ProcedureCache;
+class ProcedureCacheWriter;
 
 /* Loads and caches approaches and transitions. The corresponding approach is also loaded and cached if a
  * transition is loaded since legs depend on each other.
  *
  * All navaids and procedure are taken from the nav database.
  * All structs of MapAirport are converted to simulator database airports when passed in.
+ *
+ * The GUI instance builds a persistent cache file of all processed procedures in background after a
+ * database load. Procedures are read from this file once available instead of building them again.
  */
 class ProcedureQuery :
   public QObject
@@ -48,11 +57,30 @@ class ProcedureQuery :
   Q_OBJECT
 
 public:
+  /* Instance settings. Read in the GUI thread and passed to instances used in worker threads. */
+  struct Config
+  {
+    int procedureCacheKb;
+    bool procedureCacheFile;
+  };
+
+  /* Read configuration from settings. Call only in the GUI thread. */
+  static Config readConfig();
+
+  /*
+   * Instance for the GUI thread. Reads settings and uses the query objects from NavApp.
+   * @param sqlDbNav for updated navaids
+   */
+  explicit ProcedureQuery(atools::sql::SqlDatabase *sqlDbNav);
+
   /*
-   * @param sqlDb database for simulator scenery data
+   * Instance for worker threads. Does not access settings.
    * @param sqlDbNav for updated navaids
+   * @param mapQueryParam and airportQueryNavParam queries for navaids and runways.
+   * Have to use the same thread as sqlDbNav.
    */
-  ProcedureQuery(atools::sql::SqlDatabase *sqlDbNav);
+  ProcedureQuery(atools::sql::SqlDatabase *sqlDbNav, MapQuery *mapQueryParam, AirportQuery *airportQueryNavParam,
+                 const Config& config);
   virtual ~ProcedureQuery();
 
   const proc::MapProcedureLeg *getApproachLeg(const map::MapAirport& airport, int approachId, int legId);
@@ -107,7 +135,80 @@ public:
    *  Should only be used on a copy of a procedure object and not the cached object.*/
   void insertSidStarRunway(proc::MapProcedureLegs& legs, const QString& runway);
 
+  /* Starts loading all procedures of departure and destination airport into the cache in background */
+  void routeChanged(bool geometryChanged);
+
 private:
+  /* Settings for the query objects created in worker threads */
+  struct WorkerConfig
+  {
+    AirportQuery::Config airportQuery;
+    MapQuery::Config mapQuery;
+    ProcedureQuery::Config procedureQuery;
+  };
+
+  /* Procedures built by the prefetch worker */
+  struct PrefetchResult
+  {
+    QHash<int, proc::MapProcedureLegs> approaches; /* Approach ID to legs */
+    QHash<int, proc::MapProcedureLegs> transitions; /* Transition ID to legs including approach */
+  };
+
+  /* Start building all procedures for the given simulator airports in a worker thread.
+   * Cancels a running prefetch. */
+  void prefetchProcedures(const QList<map::MapAirport>& airports);
+
+  /* Runs in worker thread with own pooled connections and query objects */
+  PrefetchResult prefetchProceduresThread(QList<map::MapAirport> airports);
+
+  /* Called in GUI thread when worker is done. Moves results into cache. */
+  void prefetchFinished();
+
+  /* Cancel and wait for worker */
+  void cancelPrefetch();
+
+  /* Build all approaches and transitions of a navdata airport */
+  void buildAllProcedures(const map::MapAirport& airport, PrefetchResult& result);
+
+  /* Open persistent procedure cache or start building it in background if outdated. Only for GUI instance. */
+  void startProcedureCache();
+
+  /* Cancel and wait for build and close file */
+  void stopProcedureCache();
+
+  /* Distributes all airports having procedures on part workers in the procedure cache pool */
+  void buildProcedureCache();
+
+  /* Runs in worker thread with own pooled connections and query objects. Writes all procedures
+   * of the given navdata airports to the part file. */
+  bool buildProcedureCachePart(QVector<int> airportIds, ProcedureCacheWriter *writer);
+
+  /* Called in GUI thread when a part is done. Starts merging when all parts are done. */
+  void procedureCachePartFinished(bool success);
+
+  /* Runs in worker thread and concatenates all part files */
+  bool mergeProcedureCache(QString sourceFile, QString cacheFile, QString key);
+
+  /* Called in GUI thread when merging is done. Opens the file. */
+  void procedureCacheBuilt();
+
+  /* Delete writers, part files and watchers */
+  void deleteProcedureCacheParts();
+
+  /* Key for the cache file containing AIRAC cycle, unit settings used for leg texts and a hash of the
+   * simulator database used to resolve ILS */
+  static QString procedureCacheKey();
+
+  /* Load from persistent cache. Returns null if not found. */
+  proc::MapProcedureLegs *fetchCachedLegs(bool transition, int id);
+
+  /* Insert into cache and update leg index */
+  void insertApproach(int approachId, proc::MapProcedureLegs *legs);
+  void insertTransition(int transitionId, proc::MapProcedureLegs *legs);
+
+  /* Estimated memory size in kB for cache cost */
+  static int procedureCost(const proc::MapProcedureLegs& legs);
+
   proc::MapProcedureLeg buildTransitionLegEntry(const map::MapAirport& airport);
   proc::MapProcedureLeg buildApproachLegEntry(const map::MapAirport& airport);
   void buildLegEntry(atools::sql::SqlQuery *query, proc::MapProcedureLeg& leg, const map::MapAirport& airport);
@@ -170,18 +271,48 @@ private:
                         *transitionIdForLegQuery = nullptr, *approachIdForTransQuery = nullptr,
                         *runwayEndIdQuery = nullptr, *transitionQuery = nullptr, *approachQuery = nullptr,
                         *transitionIdByNameQuery = nullptr, *approachIdByNameQuery = nullptr,
-                        *approachIdByArincNameQuery = nullptr, *transitionIdsForApproachQuery = nullptr;
+                        *approachIdByArincNameQuery = nullptr, *transitionIdsForApproachQuery = nullptr,
+                        *approachIdsForAirportQuery = nullptr;
 
   /* approach ID and transition ID to full lists
-   * The approach also has to be stored for transitions since the handover can modify approach legs (CI legs, etc.) */
+   * The approach also has to be stored for transitions since the handover can modify approach legs (CI legs, etc.)
+   * Cost is estimated size in kB. */
   QCache<int, proc::MapProcedureLegs> approachCache, transitionCache;
 
+  /* Background loading of procedures for flight plan airports */
+  QFuture<PrefetchResult> prefetchFuture;
+  QFutureWatcher<PrefetchResult> prefetchWatcher;
+  std::atomic_bool prefetchCancel;
+
+  /* Simulator airport IDs of departure and destination of the last started prefetch. Empty if the
+   * prefetch was cancelled or the cache was cleared. */
+  QVector<int> prefetchAirportIds;
+
+  /* Persistent cache of processed procedures built after database load */
+  ProcedureCache *procedureCache = nullptr;
+  QString procedureCacheSourceFile, procedureCacheFile, procedureCacheKeyStr;
+  QFuture<bool> procedureCacheFuture; /* Merging */
+  QFutureWatcher<bool> procedureCacheWatcher;
+  QVector<QFutureWatcher<bool> *> procedureCachePartWatchers;
+  QVector<ProcedureCacheWriter *> procedureCacheWriters;
+  std::atomic_bool procedureCacheCancel {false};
+  bool procedureCacheBuilding = false, procedureCacheMerging = false, procedureCacheEnabled = false,
+       procedureCachePartsSuccess = true;
+  int procedureCachePartsRunning = 0, procedureCacheNumAirports = 0;
+  QElapsedTimer procedureCacheTimer;
+
+  /* Dedicated pool for part workers and merging */
+  QThreadPool procedureCachePool;
+
   /* maps leg ID to approach/transition ID and index in list */
   QHash<int, std::pair<int, int> > approachLegIndex, transitionLegIndex;
 
   MapQuery *mapQuery = nullptr;
   AirportQuery *airportQueryNav = nullptr;
 
+  /* Read in the GUI thread on construction and not changed afterwards. Only valid for the GUI instance. */
+  WorkerConfig workerConfig;
+
   /* Use this value as an id base for the artifical runway legs. Add id of the predecessor to it to be able to find the
    * leg again */
   Q_DECL_CONSTEXPR static int RUNWAY_LEG_ID_BASE = 1000000000;
@@ -192,6 +323,9 @@ private:
   /* Base id for artificial start legs */
   Q_DECL_CONSTEXPR static int START_LEG_ID_BASE = 500000000;
 
+  /* Number of threads used for building the persistent procedure cache */
+  Q_DECL_CONSTEXPR static int PROCEDURE_CACHE_THREADS = 2;
+
 };
 
 #endif // LITTLENAVMAP_APPROACHQUERY_H
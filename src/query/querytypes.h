@@ -45,8 +45,9 @@ void inflateQueryRect(Marble::GeoDataLatLonBox& rect, double factor, double incr
 
 }
 
-/* Simple spatial cache that deals with objects in a bounding rectangle but does not run any queries to load data */
-template<typename TYPE>
+/* Simple spatial cache that deals with objects in a bounding rectangle but does not run any queries to load data.
+ * LIST is the container for the objects which needs clear(), size() and isEmpty(). */
+template<typename TYPE, typename LIST = QList<TYPE> >
 struct SimpleRectCache
 {
   typedef std::function<bool (const MapLayer * curLayer, const MapLayer * mapLayer)> LayerCompareFunc;
@@ -65,15 +66,16 @@ struct SimpleRectCache
 
   Marble::GeoDataLatLonBox curRect;
   const MapLayer *curMapLayer = nullptr;
-  QList<TYPE> list;
+  LIST list;
 
 };
 
 // ---------------------------------------------------------------------------------
 
-template<typename TYPE>
-bool SimpleRectCache<TYPE>::updateCache(const Marble::GeoDataLatLonBox& rect, const MapLayer *mapLayer, double factor,
-                                        double increment, bool lazy, LayerCompareFunc funcSameLayer)
+template<typename TYPE, typename LIST>
+bool SimpleRectCache<TYPE, LIST>::updateCache(const Marble::GeoDataLatLonBox& rect, const MapLayer *mapLayer,
+                                              double factor, double increment, bool lazy,
+                                              LayerCompareFunc funcSameLayer)
 {
   if(lazy)
     // Nothing changed11
@@ -94,8 +96,8 @@ bool SimpleRectCache<TYPE>::updateCache(const Marble::GeoDataLatLonBox& rect, co
   return false;
 }
 
-template<typename TYPE>
-void SimpleRectCache<TYPE>::validate(int queryMaxRows)
+template<typename TYPE, typename LIST>
+void SimpleRectCache<TYPE, LIST>::validate(int queryMaxRows)
 {
   if(list.size() >= queryMaxRows)
   {
@@ -104,8 +106,8 @@ void SimpleRectCache<TYPE>::validate(int queryMaxRows)
   }
 }
 
-template<typename TYPE>
-void SimpleRectCache<TYPE>::clear()
+template<typename TYPE, typename LIST>
+void SimpleRectCache<TYPE, LIST>::clear()
 {
   list.clear();
   curRect.clear();
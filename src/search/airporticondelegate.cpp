@@ -31,7 +31,7 @@
 AirportIconDelegate::AirportIconDelegate(const ColumnList *columns)
   : cols(columns)
 {
-  symbolPainter = new SymbolPainter();
+  symbolPainter = new SymbolPainter(true /* use atlas */);
   mapTypesFactory = new MapTypesFactory();
 }
 
@@ -56,10 +56,14 @@ void AirportIconDelegate::paint(QPainter *painter, const QStyleOptionViewItem& o
   }
   Q_ASSERT(sqlModel != nullptr);
 
-  // Get airport from the SQL model
-  map::MapAirport ap;
-  mapTypesFactory->fillAirport(sqlModel->getSqlRecord(idx.row()), ap, true /* complete */, false /* nav */,
-                               NavApp::getCurrentSimulatorDb() == atools::fs::FsPaths::XPLANE11);
+  // Get airport from the cache or SQL model
+  bool xplane = NavApp::getCurrentSimulatorDb() == atools::fs::FsPaths::XPLANE11;
+  const map::MapAirport& ap = airportCache.value(sqlModel, idx.row(),
+                                                 [this, xplane](const atools::sql::SqlRecord& record,
+                                                                map::MapAirport& airport)
+  {
+    mapTypesFactory->fillAirport(record, airport, true /* complete */, false /* nav */, xplane);
+  });
 
   // Create a style copy
   QStyleOptionViewItem opt(option);
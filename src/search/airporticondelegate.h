@@ -18,12 +18,19 @@
 #ifndef LITTLENAVMAP_AIRPORTICONDELEGATE_H
 #define LITTLENAVMAP_AIRPORTICONDELEGATE_H
 
+#include "search/sqlmodelrowcache.h"
+
 #include <QStyledItemDelegate>
 
 class ColumnList;
 class SymbolPainter;
 class MapTypesFactory;
 
+namespace map {
+struct MapAirport;
+
+}
+
 /*
  * Paints airport icons into the "ident" cell of the search result table view.
  */
@@ -44,6 +51,9 @@ private:
   SymbolPainter *symbolPainter;
   MapTypesFactory *mapTypesFactory;
 
+  /* Decoded airports by model row */
+  mutable SqlModelRowCache<map::MapAirport> airportCache;
+
 };
 
 #endif // LITTLENAVMAP_AIRPORTICONDELEGATE_H
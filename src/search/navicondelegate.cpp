@@ -28,7 +28,7 @@
 NavIconDelegate::NavIconDelegate(const ColumnList *columns)
   : cols(columns)
 {
-  symbolPainter = new SymbolPainter();
+  symbolPainter = new SymbolPainter(true /* use atlas */);
 }
 
 NavIconDelegate::~NavIconDelegate()
@@ -63,7 +63,10 @@ void NavIconDelegate::paint(QPainter *painter, const QStyleOptionViewItem& optio
   QStyledItemDelegate::paint(painter, opt, index);
 
   // Get nav type from SQL model
-  QString navtype = sqlModel->getSqlRecord(idx.row()).valueStr("nav_type");
+  QString navtype = typeCache.value(sqlModel, idx.row(), [](const atools::sql::SqlRecord& record, QString& value)
+  {
+    value = record.valueStr("nav_type");
+  });
   map::MapObjectTypes type = map::navTypeToMapObjectType(navtype);
 
   int symbolSize = option.rect.height() - 4;
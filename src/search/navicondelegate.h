@@ -18,6 +18,8 @@
 #ifndef LITTLENAVMAP_NAVICONDELEGATE_H
 #define LITTLENAVMAP_NAVICONDELEGATE_H
 
+#include "search/sqlmodelrowcache.h"
+
 #include <QStyledItemDelegate>
 
 class ColumnList;
@@ -42,6 +44,9 @@ private:
   virtual void paint(QPainter *painter, const QStyleOptionViewItem& option,
                      const QModelIndex& index) const override;
 
+  /* Type column values by model row */
+  mutable SqlModelRowCache<QString> typeCache;
+
 };
 
 #endif // LITTLENAVMAP_NAVICONDELEGATE_H
@@ -422,6 +422,11 @@ QString SqlController::getCurrentSqlQuery() const
   return model->getCurrentSqlQuery();
 }
 
+QVariantMap SqlController::getCurrentSqlQueryBindValues() const
+{
+  return model->getCurrentSqlQueryBindValues();
+}
+
 QModelIndex SqlController::getModelIndexAt(const QPoint& pos) const
 {
   return view->indexAt(pos);
@@ -611,7 +616,7 @@ void SqlController::fillRecord(int row, atools::sql::SqlRecord& rec)
 
 QVariant SqlController::getRawData(int row, const QString& colname) const
 {
-  return getRawData(row, model->getSqlRecord().indexOf(colname));
+  return getRawData(row, model->getColumnIndex(colname));
 }
 
 QVariant SqlController::getRawData(int row, int col) const
@@ -624,7 +629,7 @@ QVariant SqlController::getRawData(int row, int col) const
 
 QVariant SqlController::getRawDataLocal(int row, const QString& colname) const
 {
-  return getRawDataLocal(row, model->getSqlRecord().indexOf(colname));
+  return getRawDataLocal(row, model->getColumnIndex(colname));
 }
 
 QVariant SqlController::getRawDataLocal(int row, int col) const
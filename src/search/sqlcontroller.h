@@ -94,6 +94,9 @@ public:
   /* Get the SQL query that was used to populate the table */
   QString getCurrentSqlQuery() const;
 
+  /* Placeholder names and values that have to be bound to the query above */
+  QVariantMap getCurrentSqlQueryBindValues() const;
+
   /* Get all descriptors for currently displayed columns */
   QVector<const Column *> getCurrentColumns() const;
 
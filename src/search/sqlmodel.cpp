@@ -25,12 +25,17 @@
 #include "exception.h"
 #include "search/column.h"
 #include "sql/sqlrecord.h"
+#include "settings/settings.h"
+#include "common/constants.h"
 
 #include <QLineEdit>
 #include <QCheckBox>
 #include <QSqlError>
 #include <QRegularExpression>
 #include <QComboBox>
+#include <QSqlQuery>
+
+#include <algorithm>
 
 using atools::sql::SqlQuery;
 using atools::sql::SqlDatabase;
@@ -40,6 +45,10 @@ using atools::sql::SqlRecord;
 SqlModel::SqlModel(QWidget *parent, SqlDatabase *sqlDb, const ColumnList *columnList)
   : QSqlQueryModel(parent), db(sqlDb), columns(columnList), parentWidget(parent)
 {
+  atools::settings::Settings& settings = atools::settings::Settings::instance();
+  statementCacheSize = settings.getAndStoreValue(lnm::SETTINGS_SEARCH + "StatementCache", 50).toInt();
+  countCache.setMaxCost(settings.getAndStoreValue(lnm::SETTINGS_SEARCH + "CountCache", 200).toInt());
+
   // Set default handler
   setDataCallback(nullptr, QSet<Qt::ItemDataRole>());
 
@@ -169,8 +178,11 @@ void SqlModel::filter(const Column *col, const QVariant& value, const QVariant&
         newVariant = maxValue;
       }
       else
-        // Min and max values set - use range and leave newVariant invalid
-        oper = QString("between %1 and %2").arg(value.toInt()).arg(maxValue.toInt());
+      {
+        // Min and max values set - use range with two bound values
+        oper = "between";
+        newVariant = QVariantList({value.toInt(), maxValue.toInt()});
+      }
     }
     else if(!col->getCondition().isEmpty())
     {
@@ -321,7 +333,32 @@ const Column *SqlModel::getColumnModel(const QString& colName) const
 
 const Column *SqlModel::getColumnModel(int colIndex) const
 {
-  return columns->getColumn(getSqlRecord().fieldName(colIndex));
+  updateColumnLookup();
+  return columnLookup.value(colIndex, nullptr);
+}
+
+int SqlModel::getColumnIndex(const QString& colName) const
+{
+  updateColumnLookup();
+  return columnIndexLookup.value(colName, -1);
+}
+
+void SqlModel::updateColumnLookup() const
+{
+  if(columnLookupGeneration == dataGeneration)
+    return;
+
+  columnLookup.clear();
+  columnIndexLookup.clear();
+
+  SqlRecord sqlRecord = getSqlRecord();
+  for(int i = 0; i < sqlRecord.count(); i++)
+  {
+    QString name = sqlRecord.fieldName(i);
+    columnLookup.append(columns->getColumn(name));
+    columnIndexLookup.insert(name, i);
+  }
+  columnLookupGeneration = dataGeneration;
 }
 
 QString SqlModel::sortOrderToSql(Qt::SortOrder order)
@@ -393,6 +430,7 @@ void SqlModel::buildQuery()
   QString queryCols = buildColumnList(tableCols);
 
   QVector<const Column *> overrideColumns;
+  currentBindValues.clear();
   QString queryWhere = buildWhere(tableCols, overrideColumns);
 
   QString queryOrder;
@@ -463,17 +501,83 @@ void SqlModel::updateTotalCount()
 {
   if(!currentSqlCountQuery.isEmpty())
   {
-    SqlQuery countStmt(db);
-    countStmt.exec(currentSqlCountQuery);
-    if(countStmt.next())
-      totalRowCount = countStmt.value(0).toInt();
+    // Key is statement plus values to catch repeated counts when typing and deleting characters.
+    // Placeholder name, type and length prefixed value avoid collisions for values containing separators.
+    QString key = currentSqlCountQuery;
+    for(auto it = currentBindValues.constBegin(); it != currentBindValues.constEnd(); ++it)
+    {
+      QString value = it.value().toString();
+      key += QString("\n%1:%2:%3:%4").arg(it.key(), QString(it.value().typeName()),
+                                          QString::number(value.size()), value);
+    }
+
+    int *count = countCache.object(key);
+    if(count != nullptr)
+      totalRowCount = *count;
     else
-      totalRowCount = 0;
+    {
+      QSqlQuery countStmt = prepareQuery(currentSqlCountQuery);
+      if(countStmt.exec() && countStmt.next())
+        totalRowCount = countStmt.value(0).toInt();
+      else
+        totalRowCount = 0;
+
+      if(countStmt.lastError().isValid())
+        atools::gui::ErrorHandler(parentWidget).handleSqlError(countStmt.lastError());
+
+      // Release the result but keep the prepared statement in the cache
+      countStmt.finish();
+      countCache.insert(key, new int(totalRowCount));
+    }
   }
   else
     totalRowCount = 0;
 }
 
+QSqlQuery SqlModel::prepareQuery(const QString& sql)
+{
+  QSqlQuery query;
+  if(statementCache.contains(sql))
+  {
+    query = statementCache.value(sql);
+    // Drop a pending result before binding new values
+    query.finish();
+  }
+  else
+  {
+    if(statementCache.size() >= statementCacheSize)
+    {
+      // Simply start over if the cache is full
+      finishStatements();
+      statementCache.clear();
+    }
+
+    query = QSqlQuery(db->getQSqlDatabase());
+    if(query.prepare(sql))
+      statementCache.insert(sql, query);
+  }
+
+  for(auto it = currentBindValues.constBegin(); it != currentBindValues.constEnd(); ++it)
+    query.bindValue(it.key(), it.value());
+  return query;
+}
+
+void SqlModel::finishStatements()
+{
+  for(QSqlQuery& query : statementCache)
+    query.finish();
+}
+
+void SqlModel::clear()
+{
+  // Prepared statements have to be removed before the database is closed
+  finishStatements();
+  statementCache.clear();
+  countCache.clear();
+  dataGeneration++;
+  QSqlQueryModel::clear();
+}
+
 /* Build where statement */
 QString SqlModel::buildWhere(const atools::sql::SqlRecord& tableCols, QVector<const Column *>& overrideColumns)
 {
@@ -526,9 +630,15 @@ QString SqlModel::buildWhere(const atools::sql::SqlRecord& tableCols, QVector<co
     // No overrides found use all columns
     whereConditions = whereConditionMap;
 
+  // Sort by column name to get the same statement for the same filter combination
+  QStringList condKeys = whereConditions.keys();
+  std::sort(condKeys.begin(), condKeys.end());
+
   int numCond = 0;
-  for(const WhereCondition& cond : whereConditions)
+  for(const QString& condKey : condKeys)
   {
+    const WhereCondition& cond = whereConditions.value(condKey);
+
     // Extract the required column from the comment in the operator and  check if it exists in the table
     QString checkCol = cond.col->getColumnName();
     QRegularExpressionMatch match = REQUIRED_COL_MATCH.match(cond.oper);
@@ -562,17 +672,16 @@ QString SqlModel::buildWhere(const atools::sql::SqlRecord& tableCols, QVector<co
     {
       QList<atools::geo::Rect> rect = boundingRect.splitAtAntiMeridian();
 
-      rectCond = QString("((lonx between %1 and %2 and laty between %3 and %4) or "
-                         "(lonx between %5 and %6 and laty between %7 and %8))").
-                 arg(rect.at(0).getTopLeft().getLonX()).arg(rect.at(0).getBottomRight().getLonX()).
-                 arg(rect.at(0).getBottomRight().getLatY()).arg(rect.at(0).getTopLeft().getLatY()).
-                 arg(rect.at(1).getTopLeft().getLonX()).arg(rect.at(1).getBottomRight().getLonX()).
-                 arg(rect.at(1).getBottomRight().getLatY()).arg(rect.at(1).getTopLeft().getLatY());
+      rectCond = "((lonx between :leftx1 and :rightx1 and laty between :bottomy1 and :topy1) or "
+                 "(lonx between :leftx2 and :rightx2 and laty between :bottomy2 and :topy2))";
+      bindRect(rect.at(0), "1");
+      bindRect(rect.at(1), "2");
     }
     else
-      rectCond = QString("(lonx between %1 and %2 and laty between %3 and %4)").
-                 arg(boundingRect.getTopLeft().getLonX()).arg(boundingRect.getBottomRight().getLonX()).
-                 arg(boundingRect.getBottomRight().getLatY()).arg(boundingRect.getTopLeft().getLatY());
+    {
+      rectCond = "(lonx between :leftx1 and :rightx1 and laty between :bottomy1 and :topy1)";
+      bindRect(boundingRect, "1");
+    }
 
     if(numCond > 0)
       queryWhere += " " + WHERE_OPERATOR + " ";
@@ -589,32 +698,65 @@ QString SqlModel::buildWhere(const atools::sql::SqlRecord& tableCols, QVector<co
   return queryWhere;
 }
 
-/* Convert a value to string for the where clause */
+/* Add a placeholder for the where clause and remember the value for binding */
 QString SqlModel::buildWhereValue(const WhereCondition& cond)
 {
   QString val;
-  if(cond.value.type() == QVariant::String || cond.value.type() == QVariant::Char)
-    // Use semicolons for string
-    val = " '" + cond.value.toString().replace("'", "''") + "'";
-  else if(cond.value.type() == QVariant::Bool ||
+  if(cond.value.type() == QVariant::List)
+  {
+    // Range for between operator
+    QVariantList range = cond.value.toList();
+    if(range.size() == 2)
+      val = " " + addBindValue(range.at(0)) + " and " + addBindValue(range.at(1));
+  }
+  else if(cond.value.type() == QVariant::String ||
+          cond.value.type() == QVariant::Char ||
+          cond.value.type() == QVariant::Bool ||
           cond.value.type() == QVariant::Int ||
           cond.value.type() == QVariant::UInt ||
           cond.value.type() == QVariant::LongLong ||
           cond.value.type() == QVariant::ULongLong ||
           cond.value.type() == QVariant::Double)
-    val = " " + cond.value.toString();
+    val = " " + addBindValue(cond.value);
   return val;
 }
 
+QString SqlModel::addBindValue(const QVariant& value)
+{
+  QString placeholder = ":where" + QString::number(currentBindValues.size());
+  currentBindValues.insert(placeholder, value);
+  return placeholder;
+}
+
+void SqlModel::bindRect(const atools::geo::Rect& rect, const QString& suffix)
+{
+  currentBindValues.insert(":leftx" + suffix, rect.getTopLeft().getLonX());
+  currentBindValues.insert(":rightx" + suffix, rect.getBottomRight().getLonX());
+  currentBindValues.insert(":bottomy" + suffix, rect.getBottomRight().getLatY());
+  currentBindValues.insert(":topy" + suffix, rect.getTopLeft().getLatY());
+}
+
 void SqlModel::refreshData()
 {
+  // Data has changed - counts are not valid anymore
+  countCache.clear();
   resetSqlQuery();
   updateTotalCount();
 }
 
 void SqlModel::resetSqlQuery()
 {
-  QSqlQueryModel::setQuery(currentSqlQuery, db->getQSqlDatabase());
+  // Release the read cursor of the previous statement. Otherwise it keeps a lock on the database
+  // while cached which blocks writers on other connections.
+  QSqlQuery previous = QSqlQueryModel::query();
+  previous.finish();
+
+  // The model shares the result with the cached statement. The query is executed again before
+  // it is passed to the model which resets all views.
+  QSqlQuery query = prepareQuery(currentSqlQuery);
+  query.exec();
+  dataGeneration++;
+  QSqlQueryModel::setQuery(query);
 
   if(lastError().isValid())
     atools::gui::ErrorHandler(parentWidget).handleSqlError(lastError());
@@ -655,8 +797,7 @@ QVariant SqlModel::data(const QModelIndex& index, int role) const
 
     // Get data to display
     QVariant dataValue = QSqlQueryModel::data(index, Qt::DisplayRole);
-    QString col = getSqlRecord().fieldName(index.column());
-    const Column *column = columns->getColumn(col);
+    const Column *column = getColumnModel(index.column());
 
     int row = -1;
     if(!boundingRect.isValid())
@@ -678,7 +819,7 @@ void SqlModel::fetchMore(const QModelIndex& parent)
 
 QVariant SqlModel::getRawData(int row, const QString& colname) const
 {
-  return getRawData(row, getSqlRecord().indexOf(colname));
+  return getRawData(row, getColumnIndex(colname));
 }
 
 void SqlModel::updateSqlQuery()
@@ -22,6 +22,10 @@
 
 #include <functional>
 
+#include <QCache>
+#include <QHash>
+#include <QVector>
+#include <QSqlQuery>
 #include <QSqlQueryModel>
 
 namespace atools {
@@ -99,11 +103,21 @@ public:
     return totalRowCount;
   }
 
+  /* Current query with placeholders. Values have to be bound using getCurrentSqlQueryBindValues. */
   QString getCurrentSqlQuery() const
   {
     return currentSqlQuery;
   }
 
+  /* Maps placeholder name to value for the current query */
+  const QVariantMap& getCurrentSqlQueryBindValues() const
+  {
+    return currentBindValues;
+  }
+
+  /* Clears model and statement caches. Has to be called before the database is closed. */
+  virtual void clear() override;
+
   /* Fetch more data and emit signal fetchedMore */
   virtual void fetchMore(const QModelIndex& parent) override;
 
@@ -120,6 +134,9 @@ public:
 
   QString getColumnName(int col) const;
 
+  /* Physical index for a query column name or -1 if not found. Resolved once per query execution. */
+  int getColumnIndex(const QString& colName) const;
+
   /* Set sort order for the given column name. Does not update or restart the query */
   void setSort(const QString& colname, Qt::SortOrder order);
 
@@ -132,6 +149,13 @@ public:
   /* Get a SQL record that contains field/column information and data for the given row */
   atools::sql::SqlRecord getSqlRecord(int row) const;
 
+  /* Changes each time the query is executed again or the model is cleared. Row based caches in delegates
+   * have to be dropped if this value changes. */
+  int getDataGeneration() const
+  {
+    return dataGeneration;
+  }
+
   /* Fetch and format data for display */
   virtual QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
 
@@ -188,12 +212,25 @@ private:
   QString buildColumnList(const atools::sql::SqlRecord& tableCols);
   QString buildWhere(const atools::sql::SqlRecord& tableCols, QVector<const Column *>& overrideColumns);
   QString buildWhereValue(const WhereCondition& cond);
+
+  /* Adds value to the bind list and returns the placeholder name */
+  QString addBindValue(const QVariant& value);
+  void bindRect(const atools::geo::Rect& rect, const QString& suffix);
+
+  /* Get a prepared statement from the cache or prepare a new one and bind the current values */
+  QSqlQuery prepareQuery(const QString& sql);
+
+  /* Release results and read locks of all cached statements but keep them prepared */
+  void finishStatements();
   void buildQuery();
   void clearWhereConditions();
   void filterBy(QModelIndex index, bool exclude);
   QString  sortOrderToSql(Qt::SortOrder order);
   QVariant defaultDataHandler(int colIndex, int rowIndex, const Column *col, const QVariant& roleValue,
                               const QVariant& displayRoleValue, Qt::ItemDataRole role) const;
+
+  /* Runs the count query or takes the result from the cache. The count is exact and not capped since exporters
+   * and selection restore depend on it. Only repeated counts for the same filter values are avoided. */
   void updateTotalCount();
 
   /* Default - all conditions are combined using "and" */
@@ -204,6 +241,29 @@ private:
 
   QString currentSqlQuery, currentSqlCountQuery;
 
+  /* Placeholder name to value for the current queries */
+  QVariantMap currentBindValues;
+
+  /* Prepared statements keyed by SQL text which only depends on the filter combination.
+   * Statements are finished before reuse and when the model switches to another statement. */
+  QHash<QString, QSqlQuery> statementCache;
+  int statementCacheSize = 50;
+
+  /* Total row count keyed by count statement and bound values */
+  QCache<QString, int> countCache;
+
+  /* Incremented on query reset or clear */
+  int dataGeneration = 0;
+
+  /* Rebuild column descriptor and index lookups if the query was executed again */
+  void updateColumnLookup() const;
+
+  /* Column descriptors by physical query index and physical index by column name.
+   * Avoids a record copy and name lookup for each cell. */
+  mutable QVector<const Column *> columnLookup;
+  mutable QHash<QString, int> columnIndexLookup;
+  mutable int columnLookupGeneration = -1;
+
   /* Data callback */
   DataFunctionType dataFunction = nullptr;
   /* Roles for the data callback */
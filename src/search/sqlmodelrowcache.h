@@ -0,0 +1,70 @@
+/*****************************************************************************
+* Copyright 2015-2018 Alexander Barthel albar965@mailbox.org
+*
+* This program is free software: you can redistribute it and/or modify
+* it under the terms of the GNU General Public License as published by
+* the Free Software Foundation, either version 3 of the License, or
+* (at your option) any later version.
+*
+* This program is distributed in the hope that it will be useful,
+* but WITHOUT ANY WARRANTY; without even the implied warranty of
+* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+* GNU General Public License for more details.
+*
+* You should have received a copy of the GNU General Public License
+* along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*****************************************************************************/
+
+#ifndef LITTLENAVMAP_SQLMODELROWCACHE_H
+#define LITTLENAVMAP_SQLMODELROWCACHE_H
+
+#include "search/sqlmodel.h"
+#include "sql/sqlrecord.h"
+
+#include <QCache>
+
+/*
+ * Caches values decoded from the rows of a SqlModel for item delegates.
+ * All values are dropped when the model or its data generation changes.
+ */
+template<typename TYPE>
+class SqlModelRowCache
+{
+public:
+  /* Number of decoded rows to keep - has to cover at least all visible rows */
+  explicit SqlModelRowCache(int maxRows = 500)
+  {
+    cache.setMaxCost(maxRows);
+  }
+
+  /* Get value for row from the cache or decode it from the model record.
+   * decode is called as decode(const atools::sql::SqlRecord& record, TYPE& value) for missing rows.
+   * The returned reference is valid until the next call. */
+  template<typename DECODER>
+  const TYPE& value(const SqlModel *sqlModel, int row, DECODER decode)
+  {
+    if(model != sqlModel || generation != sqlModel->getDataGeneration())
+    {
+      // Query or model changed - rows are not valid anymore
+      cache.clear();
+      model = sqlModel;
+      generation = sqlModel->getDataGeneration();
+    }
+
+    TYPE *val = cache.object(row);
+    if(val == nullptr)
+    {
+      val = new TYPE;
+      decode(sqlModel->getSqlRecord(row), *val);
+      cache.insert(row, val);
+    }
+    return *val;
+  }
+
+private:
+  QCache<int, TYPE> cache;
+  const SqlModel *model = nullptr;
+  int generation = -1;
+};
+
+#endif // LITTLENAVMAP_SQLMODELROWCACHE_H
@@ -21,14 +21,19 @@
 #include "search/sqlmodel.h"
 #include "common/unit.h"
 #include "common/mapflags.h"
+#include "sql/sqlrecord.h"
 
 #include <QApplication>
 
+#include <algorithm>
+
 using namespace atools::geo;
 
 SqlProxyModel::SqlProxyModel(QObject *parent, SqlModel *sqlModel)
   : QSortFilterProxyModel(parent), sourceSqlModel(sqlModel)
 {
+  // Cached values are not valid anymore if the source query changes
+  connect(sourceSqlModel, &QAbstractItemModel::modelAboutToBeReset, this, &SqlProxyModel::clearRowCache);
 }
 
 SqlProxyModel::~SqlProxyModel()
@@ -43,11 +48,47 @@ void SqlProxyModel::setDistanceFilter(const Pos& center, sqlproxymodel::SearchDi
   maxDistMeter = nmToMeter(maxDistance);
   centerPos = center;
   direction = dir;
+  clearRowCache();
 }
 
 void SqlProxyModel::clearDistanceFilter()
 {
   centerPos = Pos();
+  clearRowCache();
+}
+
+void SqlProxyModel::clearRowCache()
+{
+  rowDistMeter.clear();
+  rowHeading.clear();
+}
+
+void SqlProxyModel::updateRowCache(int sourceRow) const
+{
+  if(sourceRow < rowDistMeter.size())
+    return;
+
+  int from = rowDistMeter.size();
+  int to = sourceSqlModel->rowCount();
+
+  // Resolve column indexes once
+  atools::sql::SqlRecord rec = sourceSqlModel->getSqlRecord();
+  int lonxCol = rec.indexOf("lonx"), latyCol = rec.indexOf("laty");
+
+  // Read coordinate columns first and calculate in a separate loop
+  QVector<Pos> positions;
+  positions.reserve(to - from);
+  for(int row = from; row < to; row++)
+    positions.append(Pos(sourceSqlModel->getRawData(row, lonxCol).toFloat(),
+                         sourceSqlModel->getRawData(row, latyCol).toFloat()));
+
+  rowDistMeter.reserve(to);
+  rowHeading.reserve(to);
+  for(const Pos& pos : positions)
+  {
+    rowDistMeter.append(pos.distanceMeterTo(centerPos));
+    rowHeading.append(normalizeCourse(centerPos.angleDegTo(pos)));
+  }
 }
 
 /* Does the filtering by minimum and maximum distance and direction */
@@ -58,48 +99,48 @@ bool SqlProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex& sourcePar
   if(sourceSqlModel->isOverrideModeActive())
     return true;
 
-  Pos pos = buildPos(sourceRow);
-  float heading = normalizeCourse(centerPos.angleDegTo(pos));
+  updateRowCache(sourceRow);
+  float dist = rowDistMeter.at(sourceRow);
+  float heading = rowHeading.at(sourceRow);
 
   switch(direction)
   {
     case sqlproxymodel::ALL:
       // All directions
-      return matchDistance(pos);
+      return matchDistance(dist);
 
     case sqlproxymodel::NORTH:
       if(MIN_NORTH_DEG <= heading || heading <= MAX_NORTH_DEG)
-        return matchDistance(pos);
+        return matchDistance(dist);
       else
         return false;
 
     case sqlproxymodel::EAST:
       if(MIN_EAST_DEG <= heading && heading <= MAX_EAST_DEG)
-        return matchDistance(pos);
+        return matchDistance(dist);
       else
         return false;
 
     case sqlproxymodel::SOUTH:
       if(MIN_SOUTH_DEG <= heading && heading <= MAX_SOUTH_DEG)
-        return matchDistance(pos);
+        return matchDistance(dist);
       else
         return false;
 
     case sqlproxymodel::WEST:
       if(MIN_WEST_DEG <= heading && heading <= MAX_WEST_DEG)
-        return matchDistance(pos);
+        return matchDistance(dist);
       else
         return false;
   }
   return true;
 }
 
-bool SqlProxyModel::matchDistance(const Pos& pos) const
+bool SqlProxyModel::matchDistance(float distMeter) const
 {
   if(sourceSqlModel->isOverrideModeActive())
     return true;
 
-  float distMeter = pos.distanceMeterTo(centerPos);
   return distMeter >= minDistMeter && distMeter <= maxDistMeter;
 }
 
@@ -131,16 +172,14 @@ bool SqlProxyModel::lessThan(const QModelIndex& sourceLeft, const QModelIndex& s
   if(leftCol == "distance" && rightCol == "distance")
   {
     // Sort by distance
-    float distLeft = buildPos(sourceLeft.row()).distanceMeterTo(centerPos);
-    float distRight = buildPos(sourceRight.row()).distanceMeterTo(centerPos);
-    return distLeft < distRight;
+    updateRowCache(std::max(sourceLeft.row(), sourceRight.row()));
+    return rowDistMeter.at(sourceLeft.row()) < rowDistMeter.at(sourceRight.row());
   }
   else if(leftCol == "heading" && rightCol == "heading")
   {
     // Sort by heading
-    float headingLeft = normalizeCourse(centerPos.angleDegTo(buildPos(sourceLeft.row())));
-    float headingRight = normalizeCourse(centerPos.angleDegTo(buildPos(sourceRight.row())));
-    return headingLeft < headingRight;
+    updateRowCache(std::max(sourceLeft.row(), sourceRight.row()));
+    return rowHeading.at(sourceLeft.row()) < rowHeading.at(sourceRight.row());
   }
   else
     // Let the model do the sorting for other columns
@@ -153,7 +192,11 @@ QVariant SqlProxyModel::data(const QModelIndex& index, int role) const
   if(sourceSqlModel->getColumnName(index.column()) == "distance")
   {
     if(role == Qt::DisplayRole)
-      return Unit::distMeter(buildPos(mapToSource(index).row()).distanceMeterTo(centerPos), false);
+    {
+      int sourceRow = mapToSource(index).row();
+      updateRowCache(sourceRow);
+      return Unit::distMeter(rowDistMeter.at(sourceRow), false);
+    }
     else if(role == Qt::TextAlignmentRole)
       return Qt::AlignRight;
   }
@@ -161,7 +204,9 @@ QVariant SqlProxyModel::data(const QModelIndex& index, int role) const
   {
     if(role == Qt::DisplayRole)
     {
-      float heading = normalizeCourse(centerPos.angleDegTo(buildPos(mapToSource(index).row())));
+      int sourceRow = mapToSource(index).row();
+      updateRowCache(sourceRow);
+      float heading = rowHeading.at(sourceRow);
       if(heading < map::INVALID_COURSE_VALUE)
         return QLocale().toString(heading, 'f', 0);
       else
@@ -173,8 +218,3 @@ QVariant SqlProxyModel::data(const QModelIndex& index, int role) const
 
   return QSortFilterProxyModel::data(index, role);
 }
-
-Pos SqlProxyModel::buildPos(int row) const
-{
-  return Pos(sourceSqlModel->getRawData(row, "lonx").toFloat(), sourceSqlModel->getRawData(row, "laty").toFloat());
-}
@@ -78,8 +78,11 @@ private:
   virtual bool filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const override;
   virtual bool lessThan(const QModelIndex& sourceLeft, const QModelIndex& sourceRight) const override;
 
-  bool matchDistance(const atools::geo::Pos& pos) const;
-  atools::geo::Pos buildPos(int row) const;
+  bool matchDistance(float distMeter) const;
+
+  /* Calculates distance and heading for all source rows not covered yet */
+  void updateRowCache(int sourceRow) const;
+  void clearRowCache();
 
   /* Direction filter ranges are decreased by this value on each side */
   static float Q_DECL_CONSTEXPR DIR_RANGE_DEG = 22.5f;
@@ -95,6 +98,10 @@ private:
   sqlproxymodel::SearchDirection direction;
   float minDistMeter = 0.f, maxDistMeter = 0.f;
 
+  /* Distance to center and heading from center by source row. Filled on demand when rows are fetched and
+   * cleared when center or source query changes. */
+  mutable QVector<float> rowDistMeter, rowHeading;
+
 };
 
 #endif // LITTLENAVMAP_SQLPROXYMODEL_H
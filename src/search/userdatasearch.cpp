@@ -320,6 +320,18 @@ void UserdataSearch::postDatabaseLoad()
   setCallbacks();
 }
 
+void UserdataSearch::preImport()
+{
+  preDatabaseLoad();
+  NavApp::getMainUi()->tabUserdataSearch->setEnabled(false);
+}
+
+void UserdataSearch::postImport()
+{
+  NavApp::getMainUi()->tabUserdataSearch->setEnabled(true);
+  postDatabaseLoad();
+}
+
 /* Sets controller data formatting callback and desired data roles */
 void UserdataSearch::setCallbacks()
 {
@@ -54,6 +54,13 @@ public:
   virtual void connectSearchSlots() override;
   virtual void postDatabaseLoad() override;
 
+  /* Clears the result to release the read lock and disables the search while the import thread
+   * writes to the userdata database */
+  void preImport();
+
+  /* Enables the search and runs the query again after the import */
+  void postImport();
+
 signals:
   void addUserpoint(int id, const atools::geo::Pos& pos);
   void editUserpoints(const QVector<int>& ids);
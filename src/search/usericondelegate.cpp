@@ -27,7 +27,7 @@
 UserIconDelegate::UserIconDelegate(const ColumnList *columns, UserdataIcons *userdataIcons)
   : cols(columns), icons(userdataIcons)
 {
-  symbolPainter = new SymbolPainter();
+  symbolPainter = new SymbolPainter(true /* use atlas */);
 }
 
 UserIconDelegate::~UserIconDelegate()
@@ -54,7 +54,10 @@ void UserIconDelegate::paint(QPainter *painter, const QStyleOptionViewItem& opti
   QStyledItemDelegate::paint(painter, opt, index);
 
   // Get icon type from SQL model
-  QString type = sqlModel->getSqlRecord(idx.row()).valueStr("type");
+  QString type = typeCache.value(sqlModel, idx.row(), [](const atools::sql::SqlRecord& record, QString& value)
+  {
+    value = record.valueStr("type");
+  });
 
   // Draw icon
   painter->drawPixmap(option.rect.x() + 2, option.rect.y() + 1, *icons->getIconPixmap(type, option.rect.height() - 2));
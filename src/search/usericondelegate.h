@@ -18,6 +18,8 @@
 #ifndef LITTLENAVMAP_USERICONDELEGATE_H
 #define LITTLENAVMAP_USERICONDELEGATE_H
 
+#include "search/sqlmodelrowcache.h"
+
 #include <QStyledItemDelegate>
 
 class ColumnList;
@@ -43,6 +45,9 @@ private:
   virtual void paint(QPainter *painter, const QStyleOptionViewItem& option,
                      const QModelIndex& index) const override;
 
+  /* Type column values by model row */
+  mutable SqlModelRowCache<QString> typeCache;
+
   UserdataIcons *icons;
 };
 
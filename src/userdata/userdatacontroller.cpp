@@ -40,12 +40,22 @@
 #include "gui/errorhandler.h"
 #include "exception.h"
 #include "common/unit.h"
+#include "db/databasemanager.h"
+#include "sql/sqldatabase.h"
+#include "sql/sqlquery.h"
+#include "sql/sqlexception.h"
 
 #include <QDebug>
+#include <QMessageBox>
 #include <QStandardPaths>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <algorithm>
 
 using atools::sql::SqlTransaction;
 using atools::sql::SqlRecord;
+using atools::sql::SqlDatabase;
+using atools::sql::SqlQuery;
 using atools::geo::Pos;
 
 UserdataController::UserdataController(atools::fs::userdata::UserdataManager *userdataManager, MainWindow *parent)
@@ -55,10 +65,21 @@ UserdataController::UserdataController(atools::fs::userdata::UserdataManager *us
   icons = new UserdataIcons(mainWindow);
   icons->loadIcons();
   lastAddedRecord = new SqlRecord();
+
+  // Notification from import thread
+  connect(&importWatcher, &QFutureWatcher<int>::finished, this, &UserdataController::importFinished);
 }
 
 UserdataController::~UserdataController()
 {
+  if(importing)
+  {
+    // Import cannot be cancelled - wait for it
+    importWatcher.disconnect();
+    importFuture.waitForFinished();
+    importing = false;
+  }
+
   delete aircraftAtTakeoff;
   delete dialog;
   delete icons;
@@ -230,6 +251,9 @@ QStringList UserdataController::getAllTypes() const
 void UserdataController::addUserpointFromMap(const map::MapSearchResult& result, atools::geo::Pos pos)
 {
   qDebug() << Q_FUNC_INFO;
+  if(checkImporting())
+    return;
+
   if(result.isEmpty(map::AIRPORT | map::VOR | map::NDB | map::WAYPOINT))
     // No prefill start empty dialog of with last added data
     addUserpoint(-1, pos);
@@ -290,6 +314,9 @@ void UserdataController::deleteUserpointFromMap(int id)
 
 void UserdataController::moveUserpointFromMap(const map::MapUserpoint& userpoint)
 {
+  if(checkImporting())
+    return;
+
   SqlRecord rec;
   rec.appendFieldAndValue("lonx", userpoint.position.getLonX());
   rec.appendFieldAndValue("laty", userpoint.position.getLatY());
@@ -317,6 +344,7 @@ void UserdataController::clearTemporary()
 
 void UserdataController::setMagDecReader(atools::fs::common::MagDecReader *magDecReader)
 {
+  this->magDecReader = magDecReader;
   manager->setMagDecReader(magDecReader);
 }
 
@@ -473,6 +501,14 @@ void UserdataController::createTakoffLanding(const atools::fs::sc::SimConnectUse
     }
     record.setValue("description", description.join("\n"));
 
+    if(importing)
+    {
+      // Database is locked by the import thread
+      qWarning() << Q_FUNC_INFO << "Logbook entry not added since import is running";
+      mainWindow->setStatusMessage(tr("Logbook entry not added. Userpoint import is running."));
+      return;
+    }
+
     // Add to database
     SqlTransaction transaction(manager->getDatabase());
     manager->insertByRecord(record);
@@ -507,6 +543,9 @@ void UserdataController::addUserpointInternal(int id, const atools::geo::Pos& po
 {
   qDebug() << Q_FUNC_INFO;
 
+  if(checkImporting())
+    return;
+
   SqlRecord rec;
 
   if(id != -1 /*&& lastAddedRecord->isEmpty()*/)
@@ -566,6 +605,9 @@ void UserdataController::editUserpoints(const QVector<int>& ids)
 {
   qDebug() << Q_FUNC_INFO;
 
+  if(checkImporting())
+    return;
+
   SqlRecord rec = manager->getRecord(ids.first());
   if(!rec.isEmpty())
   {
@@ -595,6 +637,9 @@ void UserdataController::deleteUserpoints(const QVector<int>& ids)
 {
   qDebug() << Q_FUNC_INFO;
 
+  if(checkImporting())
+    return;
+
   QMessageBox::StandardButton retval =
     QMessageBox::question(mainWindow, QApplication::applicationName(),
                           tr("Delete %n userpoint(s)?", "", ids.size()));
@@ -621,18 +666,9 @@ void UserdataController::importCsv()
       tr("Open Userpoint CSV File(s)"),
       tr("CSV Files %1;;All Files (*)").arg(lnm::FILE_PATTERN_USERDATA_CSV), "Userdata/Csv");
 
-    int numImported = 0;
-    for(const QString& file:files)
-    {
-      if(!file.isEmpty())
-        numImported += manager->importCsv(file, atools::fs::userdata::NONE, ',', '"');
-    }
-
+    files.removeAll(QString());
     if(!files.isEmpty())
-    {
-      mainWindow->setStatusMessage(tr("%n userpoint(s) imported.", "", numImported));
-      emit refreshUserdataSearch(false /* load all */, false /* keep selection */);
-    }
+      startImport(IMPORT_CSV, files);
   }
   catch(atools::Exception& e)
   {
@@ -656,11 +692,7 @@ void UserdataController::importXplaneUserFixDat()
       xplaneUserWptDatPath());
 
     if(!file.isEmpty())
-    {
-      int numImported = manager->importXplane(file);
-      mainWindow->setStatusMessage(tr("%n userpoint(s) imported.", "", numImported));
-      emit refreshUserdataSearch(false /* load all */, false /* keep selection */);
-    }
+      startImport(IMPORT_XPLANE, {file});
   }
   catch(atools::Exception& e)
   {
@@ -683,11 +715,7 @@ void UserdataController::importGarmin()
       garminGtnUserWptPath());
 
     if(!file.isEmpty())
-    {
-      int numImported = manager->importGarmin(file);
-      mainWindow->setStatusMessage(tr("%n userpoint(s) imported.", "", numImported));
-      emit refreshUserdataSearch(false /* load all */, false /* keep selection */);
-    }
+      startImport(IMPORT_GARMIN, {file});
   }
   catch(atools::Exception& e)
   {
@@ -699,9 +727,238 @@ void UserdataController::importGarmin()
   }
 }
 
+bool UserdataController::checkImporting()
+{
+  if(importing)
+    mainWindow->setStatusMessage(tr("Userpoint import is running. Try again when done."));
+  return importing;
+}
+
+void UserdataController::startImport(ImportFormat format, const QStringList& files)
+{
+  if(importing)
+  {
+    mainWindow->setStatusMessage(tr("Userpoint import is already running."));
+    return;
+  }
+
+  qDebug() << Q_FUNC_INFO << format << files;
+
+  // Prepare settings here since they cannot be accessed from the thread
+  QStringList pragmas = NavApp::getDatabaseManager()->buildDatabasePragmas(false /* readonly */,
+                                                                           false /* exclusive */);
+  // Wait longer than the GUI connection for short map and information reads to finish
+  pragmas.append(QString("PRAGMA busy_timeout=%1").arg(IMPORT_BUSY_TIMEOUT_MS));
+  QString databaseFile = manager->getDatabase()->databaseName();
+
+  // Release all readers of the userdata database in the GUI thread. An open cursor of the search result
+  // holds a shared lock which lets all commits of the import connection fail.
+  NavApp::getUserdataSearch()->preImport();
+
+  importException = nullptr;
+  importLocked = false;
+  importing = true;
+  importTimer.start();
+  mainWindow->setStatusMessage(tr("Importing userpoints ..."));
+
+  // Watcher will call importFinished when done
+  importFuture = QtConcurrent::run(this, &UserdataController::importThread, format, files, databaseFile, pragmas);
+  importWatcher.setFuture(importFuture);
+}
+
+int UserdataController::importThread(ImportFormat format, const QStringList& files, const QString& databaseFile,
+                                     const QStringList& pragmas)
+{
+  int numImported = 0;
+
+  // Connection has to be created in this thread
+  SqlDatabase::addDatabase(DATABASE_TYPE, DATABASE_NAME_IMPORT);
+  {
+    SqlDatabase db(DATABASE_NAME_IMPORT);
+
+    // Names and create statements of the indexes which are dropped during import
+    QStringList indexNames, indexStatements;
+    try
+    {
+      db.setDatabaseName(databaseFile);
+      db.setAutocommit(false);
+      db.open(pragmas);
+
+      // Remember and drop indexes to avoid updating them for each inserted row
+      SqlQuery query(&db);
+      query.exec("select name, sql from sqlite_master "
+                 "where type = 'index' and tbl_name = 'userdata' and sql is not null");
+      while(query.next())
+      {
+        indexNames.append(query.valueStr("name"));
+        indexStatements.append(query.valueStr("sql"));
+      }
+      query.finish();
+
+      for(const QString& name : indexNames)
+        query.exec("drop index if exists " + name);
+
+      // The import methods commit on their own - an outer transaction cannot roll back the dropped indexes
+      db.commit();
+
+      atools::fs::userdata::UserdataManager importManager(&db);
+      importManager.setMagDecReader(magDecReader);
+
+      for(const QString& file : files)
+      {
+        switch(format)
+        {
+          case IMPORT_CSV:
+            numImported += importManager.importCsv(file, atools::fs::userdata::NONE, ',', '"');
+            break;
+
+          case IMPORT_XPLANE:
+            numImported += importManager.importXplane(file);
+            break;
+
+          case IMPORT_GARMIN:
+            numImported += importManager.importGarmin(file);
+            break;
+        }
+      }
+
+      // Rebuild indexes in one go
+      recreateUserdataIndexes(db, indexNames, indexStatements);
+    }
+    catch(...)
+    {
+      std::exception_ptr exception = std::current_exception();
+      if(isDatabaseLocked(exception))
+        // Keep the number of points from files committed before
+        importLocked = true;
+      else
+      {
+        // Pass exception to the GUI thread to show the error dialog
+        importException = exception;
+        numImported = 0;
+      }
+
+      // Files imported before the error are already committed - restore the indexes in any case
+      if(db.isOpen() && !indexNames.isEmpty())
+      {
+        try
+        {
+          db.rollback();
+          recreateUserdataIndexes(db, indexNames, indexStatements);
+        }
+        catch(std::exception& e)
+        {
+          qWarning() << Q_FUNC_INFO << "Restoring userdata indexes failed" << e.what();
+        }
+      }
+    }
+
+    if(db.isOpen())
+      db.close();
+  }
+  SqlDatabase::removeDatabase(DATABASE_NAME_IMPORT);
+
+  return numImported;
+}
+
+bool UserdataController::isDatabaseLocked(std::exception_ptr exception)
+{
+  try
+  {
+    std::rethrow_exception(exception);
+  }
+  catch(atools::sql::SqlException& e)
+  {
+    // SQLITE_BUSY or SQLITE_LOCKED - extended result codes keep the primary code in the lower byte
+    int code = e.getSqlError().nativeErrorCode().toInt() & 0xff;
+    return code == 5 || code == 6;
+  }
+  catch(...)
+  {
+    return false;
+  }
+}
+
+void UserdataController::recreateUserdataIndexes(SqlDatabase& db, const QStringList& indexNames,
+                                                 const QStringList& indexStatements)
+{
+  SqlQuery query(&db);
+  for(int i = 0; i < indexNames.size(); i++)
+  {
+    // Skip indexes which were not dropped
+    query.prepare("select count(*) from sqlite_master where type = 'index' and name = :name");
+    query.bindValue(":name", indexNames.at(i));
+    query.exec();
+    bool exists = query.next() && query.value(0).toInt() > 0;
+    query.finish();
+
+    if(!exists)
+      query.exec(indexStatements.at(i));
+  }
+  db.commit();
+}
+
+void UserdataController::importFinished()
+{
+  int numImported = importFuture.result();
+  qint64 elapsedMs = std::max(importTimer.elapsed(), static_cast<qint64>(1));
+  importing = false;
+
+  // Query the search result again
+  NavApp::getUserdataSearch()->postImport();
+
+  if(importException)
+  {
+    try
+    {
+      std::rethrow_exception(importException);
+    }
+    catch(atools::Exception& e)
+    {
+      atools::gui::ErrorHandler(mainWindow).handleException(e);
+    }
+    catch(...)
+    {
+      atools::gui::ErrorHandler(mainWindow).handleUnknownException();
+    }
+    importException = nullptr;
+    mainWindow->setStatusMessage(tr("Userpoint import failed."));
+    return;
+  }
+
+  int perSecond = static_cast<int>(numImported * 1000LL / elapsedMs);
+  qInfo() << Q_FUNC_INFO << "Imported" << numImported << "userpoints in" << elapsedMs << "ms"
+          << perSecond << "per second";
+
+  if(importLocked)
+  {
+    importLocked = false;
+    mainWindow->setStatusMessage(tr("Userpoint import stopped. Database is locked."));
+    QMessageBox::warning(mainWindow, QApplication::applicationName(),
+                         tr("Userpoint import was stopped since the userdata database is locked by "
+                            "another connection or program.
+
+"
+                            "%n userpoint(s) from files loaded before were imported.
+"
+                            "Try to import the remaining files again.", "", numImported));
+  }
+  else
+    mainWindow->setStatusMessage(tr("%n userpoint(s) imported in %1 seconds (%2 per second).", "", numImported).
+                                 arg(elapsedMs / 1000., 0, 'f', 1).arg(perSecond));
+
+  // Update search and map only once
+  emit refreshUserdataSearch(false /* load all */, false /* keep selection */);
+  emit userdataChanged();
+}
+
 void UserdataController::exportCsv()
 {
   qDebug() << Q_FUNC_INFO;
+
+  if(checkImporting())
+    return;
+
   try
   {
     bool exportSelected, append;
@@ -737,6 +994,10 @@ void UserdataController::exportCsv()
 void UserdataController::exportXplaneUserFixDat()
 {
   qDebug() << Q_FUNC_INFO;
+
+  if(checkImporting())
+    return;
+
   try
   {
     bool exportSelected, append;
@@ -773,6 +1034,10 @@ void UserdataController::exportXplaneUserFixDat()
 void UserdataController::exportGarmin()
 {
   qDebug() << Q_FUNC_INFO;
+
+  if(checkImporting())
+    return;
+
   try
   {
     bool exportSelected, append;
@@ -809,6 +1074,10 @@ void UserdataController::exportGarmin()
 void UserdataController::exportBglXml()
 {
   qDebug() << Q_FUNC_INFO;
+
+  if(checkImporting())
+    return;
+
   try
   {
     bool exportSelected, append;
@@ -845,6 +1114,9 @@ void UserdataController::clearDatabase()
 {
   qDebug() << Q_FUNC_INFO;
 
+  if(checkImporting())
+    return;
+
   QMessageBox::StandardButton retval =
     QMessageBox::question(mainWindow, QApplication::applicationName(),
                           tr("Really delete all userpoints?\n\n"
@@ -857,6 +1129,7 @@ void UserdataController::clearDatabase()
   {
     manager->clearData();
     emit refreshUserdataSearch(false /* load all */, false /* keep selection */);
+    emit userdataChanged();
   }
 }
 
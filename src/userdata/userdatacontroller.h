@@ -20,6 +20,10 @@
 
 #include <QObject>
 #include <QVector>
+#include <QFutureWatcher>
+#include <QElapsedTimer>
+
+#include <exception>
 
 namespace atools {
 namespace sql {
@@ -162,6 +166,37 @@ signals:
   void userdataChanged();
 
 private:
+  /* File formats for the background import */
+  enum ImportFormat
+  {
+    IMPORT_CSV,
+    IMPORT_XPLANE,
+    IMPORT_GARMIN
+  };
+
+  /* Starts import of the given files in a background thread. Map and search are updated once when done. */
+  void startImport(ImportFormat format, const QStringList& files);
+
+  /* Background thread. Imports all files into the userdata database using its own connection.
+   * Indexes are dropped before and recreated after loading, also if loading fails.
+   * Returns number of imported points. */
+  int importThread(ImportFormat format, const QStringList& files, const QString& databaseFile,
+                   const QStringList& pragmas);
+
+  /* true if the exception is an SQL error caused by a busy or locked database */
+  static bool isDatabaseLocked(std::exception_ptr exception);
+
+  /* Create all given indexes which do not exist and commit */
+  static void recreateUserdataIndexes(atools::sql::SqlDatabase& db, const QStringList& indexNames,
+                                      const QStringList& indexStatements);
+
+  /* Shows a message and returns true if the background import is running. Used to block all
+   * modifications and exports of the userdata database while importing. */
+  bool checkImporting();
+
+  /* Called by watcher when the import thread is finished */
+  void importFinished();
+
   /* Called by any action */
   void toolbarActionTriggered();
 
@@ -197,6 +232,21 @@ private:
   QAction *actionAll = nullptr, *actionNone = nullptr, *actionUnknown = nullptr;
   QVector<QAction *> actions;
   atools::sql::SqlRecord *lastAddedRecord = nullptr;
+  atools::fs::common::MagDecReader *magDecReader = nullptr;
+
+  /* Background import */
+  QFuture<int> importFuture;
+  QFutureWatcher<int> importWatcher;
+  std::exception_ptr importException;
+  QElapsedTimer importTimer;
+  bool importing = false;
+
+  /* Import stopped since the database was busy. Files loaded before are committed. */
+  bool importLocked = false;
+
+  const QString DATABASE_NAME_IMPORT = "LNMDBUSERIMPORT";
+  const int IMPORT_BUSY_TIMEOUT_MS = 10000;
+  const QString DATABASE_TYPE = "QSQLITE";
 
 };
 